@@ -6,62 +6,306 @@
 
 #include "lsm303agr.h"
 
-#include "nrf_delay.h"
-#include "nrfx_twim.h"
+#include "app_util_platform.h"
+#include "lsm303agr_bus_trace.h"
+#include "nrf_assert.h"
+#include "profile/profile.h"
+
+#include <string.h>
 
 #define NRF_LOG_MODULE_NAME LSM303AGR
 #define NRF_LOG_LEVEL 3 // LOG_LEVEL
 #include "nrfx_log.h"
 NRF_LOG_MODULE_REGISTER();
 
-bool lsm303agr_write_buffer(uint8_t addr, uint8_t reg, uint8_t *buffer, uint16_t len)
+#define TRACE_MODULE_LEVEL TRACE_LEVEL_DEBUG // Register accesses are traced in debug builds only.
+#include "trace/trace.h"
+
+typedef enum {
+    XFER_WRITE, // Register address followed by the payload.
+    XFER_READ,  // Register address, then the payload is received.
+} xfer_dir_t;
+
+typedef struct {
+    uint8_t                  addr;      // Device I2C address.
+    xfer_dir_t               dir;       // Transfer direction.
+    uint8_t                 *p_data;    // RX buffer for reads.
+    uint16_t                 len;       // Payload length in bytes.
+    lsm303agr_xfer_handler_t handler;   // Completion handler.
+    void                    *p_context; // Completion handler context.
+
+    // Register address followed by the write payload, sent as one DMA buffer.
+    uint8_t tx[1 + LSM303AGR_XFER_MAX_WRITE];
+} lsm303agr_xfer_t;
+
+typedef struct {
+    volatile bool done;    // Set by the completion handler.
+    volatile bool success; // Transfer result.
+} xfer_wait_t;
+
+static const lsm303agr_bus_t *mp_bus = NULL; // Bus operations.
+
+static lsm303agr_xfer_t m_xfer_queue[LSM303AGR_XFER_QUEUE_SIZE]; // Pending transfers, head is on the bus.
+static volatile uint8_t m_xfer_head  = 0;
+static volatile uint8_t m_xfer_count = 0;
+static volatile bool    m_bus_owned  = false; // Bus is owned outside the queue, transfers are held.
+
+#if PROFILE_ENABLED
+static uint32_t m_xfer_begin; // Start of the transfer on the bus.
+#endif
+
+static nrfx_err_t xfer_start(lsm303agr_xfer_t *p_xfer)
+{
+    PROFILE_STAMP(m_xfer_begin);
+
+    if (p_xfer->dir == XFER_WRITE) {
+        return mp_bus->write(p_xfer->addr, p_xfer->tx, p_xfer->len);
+    }
+
+    return mp_bus->read(p_xfer->addr, p_xfer->tx, p_xfer->p_data, p_xfer->len);
+}
+
+/**@brief       Start transfers from the head of the queue until one is accepted by the driver.
+ *
+ */
+static void xfer_queue_start(void)
+{
+    while (true) {
+        lsm303agr_xfer_t *p_xfer;
+
+        CRITICAL_REGION_ENTER();
+        p_xfer = ((m_xfer_count > 0) && !m_bus_owned) ? &m_xfer_queue[m_xfer_head] : NULL;
+        CRITICAL_REGION_EXIT();
+
+        if (p_xfer == NULL) {
+            return;
+        }
+
+        nrfx_err_t status = xfer_start(p_xfer);
+        if (status == NRFX_SUCCESS) {
+            return;
+        }
+
+        NRFX_LOG_WARNING("%s Transfer start failed error: 0x%x.", __func__, status);
+
+        lsm303agr_xfer_handler_t handler   = p_xfer->handler;
+        void                    *p_context = p_xfer->p_context;
+
+        CRITICAL_REGION_ENTER();
+        m_xfer_head = (m_xfer_head + 1) % LSM303AGR_XFER_QUEUE_SIZE;
+        m_xfer_count--;
+        CRITICAL_REGION_EXIT();
+
+        if (handler != NULL) {
+            handler(false, p_context);
+        }
+    }
+}
+
+/**@brief       Complete the transfer on the bus and start the next one.
+ *
+ * @param[in]   success   -   Transfer result.
+ */
+static void xfer_queue_complete(bool success)
+{
+    lsm303agr_xfer_t        *p_xfer    = &m_xfer_queue[m_xfer_head];
+    lsm303agr_xfer_handler_t handler   = p_xfer->handler;
+    void                    *p_context = p_xfer->p_context;
+
+    CRITICAL_REGION_ENTER();
+    m_xfer_head = (m_xfer_head + 1) % LSM303AGR_XFER_QUEUE_SIZE;
+    m_xfer_count--;
+    CRITICAL_REGION_EXIT();
+
+    // Keep the bus busy before notifying the user.
+    xfer_queue_start();
+
+    if (handler != NULL) {
+        handler(success, p_context);
+    }
+}
+
+static bool xfer_queue_push(uint8_t addr, uint8_t reg, xfer_dir_t dir, const uint8_t *buffer, uint16_t len, lsm303agr_xfer_handler_t handler,
+                            void *p_context)
 {
-    nrfx_twim_xfer_desc_t reg_xfer  = NRFX_TWIM_XFER_DESC_TX(addr, &reg, sizeof(reg));
-    nrfx_twim_xfer_desc_t data_xfer = NRFX_TWIM_XFER_DESC_TX(addr, buffer, len);
+    bool idle = false;
+    bool full = false;
 
-    // Writing register to LSM303AGR using I2C.
-    nrfx_err_t status = nrfx_twim_xfer(p_twi_master, &reg_xfer, NRFX_TWIM_FLAG_TX_NO_STOP);
-    if (status != NRFX_SUCCESS) {
-        NRFX_LOG_WARNING("%s Write transfer failed error: 0x%x.", __func__, status);
+    if (mp_bus == NULL) {
+        NRFX_LOG_WARNING("%s Bus is not initialized.", __func__);
         return false;
     }
 
-    // Writing data to LSM303AGR using I2C.
-    status = nrfx_twim_xfer(p_twi_master, &data_xfer, 0);
-    if (status != NRFX_SUCCESS) {
-        NRFX_LOG_WARNING("%s Write transfer failed error: 0x%x.", __func__, status);
+    if ((dir == XFER_WRITE) && (len > LSM303AGR_XFER_MAX_WRITE)) {
+        NRFX_LOG_WARNING("%s Write of %d bytes exceeds the scratch buffer.", __func__, len);
         return false;
     }
 
-    NRFX_LOG_INFO("%s Write addr: 0x%x, register: 0x%x.", __func__, addr, reg);
-    NRFX_LOG_HEXDUMP_INFO(buffer, len);
+    CRITICAL_REGION_ENTER();
+    if (m_xfer_count == LSM303AGR_XFER_QUEUE_SIZE) {
+        full = true;
+    } else {
+        lsm303agr_xfer_t *p_xfer = &m_xfer_queue[(m_xfer_head + m_xfer_count) % LSM303AGR_XFER_QUEUE_SIZE];
+
+        p_xfer->addr      = addr;
+        p_xfer->dir       = dir;
+        p_xfer->p_data    = (uint8_t *)buffer;
+        p_xfer->len       = len;
+        p_xfer->handler   = handler;
+        p_xfer->p_context = p_context;
+        p_xfer->tx[0]     = reg;
+
+        // Write payload is copied so the caller buffer may live on the stack or in flash.
+        if (dir == XFER_WRITE) {
+            memcpy(&p_xfer->tx[1], buffer, len);
+        }
+
+        idle = (m_xfer_count == 0) && !m_bus_owned;
+        m_xfer_count++;
+    }
+    CRITICAL_REGION_EXIT();
+
+    if (full) {
+        NRFX_LOG_WARNING("%s Transfer queue is full.", __func__);
+        return false;
+    }
+
+    // The bus is idle, nobody else will start this transfer.
+    if (idle) {
+        xfer_queue_start();
+    }
 
     return true;
 }
 
-bool lsm303agr_write_register(uint8_t addr, uint8_t reg, uint8_t value) { return lsm303agr_write_buffer(addr, reg, &value, sizeof(value)); }
+static void xfer_wait_handler(bool success, void *p_context)
+{
+    xfer_wait_t *p_wait = p_context;
 
-bool lsm303agr_read_continuous(uint8_t addr, uint8_t reg, uint8_t *buffer, uint16_t len)
+    p_wait->success = success;
+    p_wait->done    = true;
+}
+
+/**@brief       Sleep until a queued transfer is done.
+ *
+ * @param[in]   p_wait    -   Wait context passed to xfer_wait_handler().
+ *
+ * @retval  True if transfer completed successfully.
+ */
+static bool xfer_wait(xfer_wait_t *p_wait)
+{
+    // Woken up by the bus interrupt.
+    while (!p_wait->done) {
+        __WFE();
+    }
+
+    return p_wait->success;
+}
+
+bool lsm303agr_init(const lsm303agr_bus_t *p_bus)
+{
+    ASSERT(p_bus);
+
+    if ((p_bus == NULL) || (p_bus->write == NULL) || (p_bus->read == NULL)) {
+        return false;
+    }
+
+    mp_bus = p_bus;
+
+    return true;
+}
+
+const lsm303agr_bus_t *lsm303agr_bus_get(void) { return mp_bus; }
+
+void lsm303agr_bus_xfer_done(bool success)
+{
+    PROFILE_SINCE(BUS_XFER, m_xfer_begin);
+
+    if (!success) {
+        lsm303agr_xfer_t *p_xfer = &m_xfer_queue[m_xfer_head];
+
+        NRFX_LOG_WARNING("%s Transfer failed addr: 0x%x, register: 0x%x.", __func__, p_xfer->addr, p_xfer->tx[0]);
+    }
+
+    xfer_queue_complete(success);
+}
+
+bool lsm303agr_write_buffer_async(uint8_t addr, uint8_t reg, const uint8_t *buffer, uint16_t len, lsm303agr_xfer_handler_t handler,
+                                  void *p_context)
+{
+    return xfer_queue_push(addr, reg, XFER_WRITE, buffer, len, handler, p_context);
+}
+
+bool lsm303agr_read_continuous_async(uint8_t addr, uint8_t reg, uint8_t *buffer, uint16_t len, lsm303agr_xfer_handler_t handler,
+                                     void *p_context)
+{
+    return xfer_queue_push(addr, reg, XFER_READ, buffer, len, handler, p_context);
+}
+
+bool lsm303agr_bus_acquire(void)
+{
+    bool ret = false;
+
+    CRITICAL_REGION_ENTER();
+    if ((m_xfer_count == 0) && !m_bus_owned) {
+        m_bus_owned = true;
+        ret         = true;
+    }
+    CRITICAL_REGION_EXIT();
+
+    return ret;
+}
+
+void lsm303agr_bus_release(void)
 {
-    nrfx_twim_xfer_desc_t reg_xfer  = NRFX_TWIM_XFER_DESC_TX(addr, &reg, sizeof(reg));
-    nrfx_twim_xfer_desc_t data_xfer = NRFX_TWIM_XFER_DESC_RX(addr, buffer, len);
+    m_bus_owned = false;
+
+    // Start transfers queued while the bus was owned.
+    xfer_queue_start();
+}
+
+bool lsm303agr_write_buffer(uint8_t addr, uint8_t reg, uint8_t *buffer, uint16_t len)
+{
+    xfer_wait_t wait = {0};
+
+    // Writing register and data to LSM303AGR.
+    PROFILE_BEGIN(BUS_WRITE);
+    bool success = lsm303agr_write_buffer_async(addr, reg, buffer, len, xfer_wait_handler, &wait) && xfer_wait(&wait);
+    PROFILE_END(BUS_WRITE);
 
-    // Writing the address to I2C bus.
-    nrfx_err_t status = nrfx_twim_xfer(p_twi_master, &reg_xfer, NRFX_TWIM_FLAG_TX_NO_STOP);
-    if (status != NRFX_SUCCESS) {
-        NRFX_LOG_WARNING("%s Write transfer failed error: 0x%x.", __func__, status);
+    lsm303agr_bus_trace_record(addr, reg, buffer, len, success ? LSM303AGR_BUS_TRACE_OK : 0);
+
+    if (!success) {
+        NRFX_LOG_WARNING("%s Write transfer failed addr: 0x%x, register: 0x%x.", __func__, addr, reg);
         return false;
     }
 
-    // Reading register from LSM303AGR using I2C.
-    status = nrfx_twim_xfer(p_twi_master, &data_xfer, 0);
-    if (status != NRFX_SUCCESS) {
-        NRFX_LOG_WARNING("%s Read transfer failed error: 0x%x.", __func__, status);
+    TRACE_DEBUG(BUS_WRITE, addr, reg);
+    TRACE_DEBUG_DATA(BUS_DATA, buffer, len);
+
+    return true;
+}
+
+bool lsm303agr_write_register(uint8_t addr, uint8_t reg, uint8_t value) { return lsm303agr_write_buffer(addr, reg, &value, sizeof(value)); }
+
+bool lsm303agr_read_continuous(uint8_t addr, uint8_t reg, uint8_t *buffer, uint16_t len)
+{
+    xfer_wait_t wait = {0};
+
+    // Reading register from LSM303AGR.
+    PROFILE_BEGIN(BUS_READ);
+    bool success = lsm303agr_read_continuous_async(addr, reg, buffer, len, xfer_wait_handler, &wait) && xfer_wait(&wait);
+    PROFILE_END(BUS_READ);
+
+    lsm303agr_bus_trace_record(addr, reg, buffer, len, LSM303AGR_BUS_TRACE_READ | (success ? LSM303AGR_BUS_TRACE_OK : 0));
+
+    if (!success) {
+        NRFX_LOG_WARNING("%s Read transfer failed addr: 0x%x, register: 0x%x.", __func__, addr, reg);
         return false;
     }
 
-    NRFX_LOG_INFO("%s Read address: 0x%x, register: 0x%x.", __func__, addr, reg);
-    NRFX_LOG_HEXDUMP_INFO(buffer, len);
+    TRACE_DEBUG(BUS_READ, addr, reg);
+    TRACE_DEBUG_DATA(BUS_DATA, buffer, len);
 
     return true;
 }
@@ -82,4 +326,4 @@ uint8_t lsm303agr_read_register(uint8_t addr, uint8_t reg)
     }
 
     return value;
-}
\ No newline at end of file
+}
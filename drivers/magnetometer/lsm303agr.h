@@ -8,16 +8,117 @@
 
 #include "lsm303agr_types.h"
 
-extern const nrfx_twim_t *p_twi_master;
+/** Maximum number of transfers waiting for the bus. */
+#ifndef LSM303AGR_XFER_QUEUE_SIZE
+#define LSM303AGR_XFER_QUEUE_SIZE 4
+#endif
+
+/** Maximum payload of a single register write, each queue slot owns a scratch buffer of this size. */
+#ifndef LSM303AGR_XFER_MAX_WRITE
+#define LSM303AGR_XFER_MAX_WRITE 8
+#endif
+
+typedef enum {
+    LSM303AGR_BUS_TWIM, // I2C through the TWIM peripheral.
+    LSM303AGR_BUS_SPIM, // 3-wire SPI through the SPIM peripheral.
+} lsm303agr_bus_type_t;
+
+// Bus operations, implemented by lsm303agr_twim.c and lsm303agr_spim.c.
+typedef struct {
+    lsm303agr_bus_type_t type;
+
+    /**@brief       Start writing a register, completion is reported with lsm303agr_bus_xfer_done().
+     *
+     * @param[in]   addr      -   Device I2C address, identifies the device on SPI as well.
+     * @param[in]   p_tx      -   Register address followed by len bytes of payload, located in RAM.
+     *                            The backend may rewrite the register address into its bus command.
+     * @param[in]   len       -   Payload length in bytes.
+     */
+    nrfx_err_t (*write)(uint8_t addr, uint8_t *p_tx, uint16_t len);
+
+    /**@brief       Start reading registers, completion is reported with lsm303agr_bus_xfer_done().
+     *
+     * @param[in]   addr      -   Device I2C address, identifies the device on SPI as well.
+     * @param[in]   p_tx      -   Register address, located in RAM.
+     * @param[out]  p_rx      -   Received data, located in RAM.
+     * @param[in]   len       -   Length of received data in bytes.
+     */
+    nrfx_err_t (*read)(uint8_t addr, uint8_t *p_tx, uint8_t *p_rx, uint16_t len);
+} lsm303agr_bus_t;
+
+/**@brief       Asynchronous transfer completion handler.
+ *
+ * @param[in]   success   -   True if the transfer completed successfully.
+ * @param[in]   p_context -   Context passed when the transfer was queued.
+ */
+typedef void (*lsm303agr_xfer_handler_t)(bool success, void *p_context);
 
 /**@brief       Function for initializing LSM303AGR device.
+ *
+ * @param[in]   p_bus     -   Bus operations, see lsm303agr_twim_bus() and lsm303agr_spim_bus().
+ *
+ * @retval  True if initialized.
+ */
+bool lsm303agr_init(const lsm303agr_bus_t *p_bus);
+
+/** Bus selected at initialization. */
+const lsm303agr_bus_t *lsm303agr_bus_get(void);
+
+/**@brief       Report completion of the transfer started by the bus backend, called from its interrupt.
+ *
+ * @param[in]   success   -   True if the transfer completed successfully.
+ */
+void lsm303agr_bus_xfer_done(bool success);
+
+/**@brief       Queue a write of buffer to LSM303AGR register.
+ *
+ * @note        The buffer is copied into the queue, at most LSM303AGR_XFER_MAX_WRITE bytes.
+ *
+ * @param[in]   addr      -   Device I2C address.
+ * @param[in]   reg       -   Register to write to.
+ * @param[in]   buffer    -   Pointer to transferred data.
+ * @param[in]   len       -   Length of buffer in bytes.
+ * @param[in]   handler   -   Completion handler, may be NULL.
+ * @param[in]   p_context -   Context passed to the handler.
+ *
+ * @retval  True if the transfer was queued.
+ */
+bool lsm303agr_write_buffer_async(uint8_t addr, uint8_t reg, const uint8_t *buffer, uint16_t len, lsm303agr_xfer_handler_t handler,
+                                  void *p_context);
+
+/**@brief       Queue a read of LSM303AGR registers.
+ *
+ * @note        The buffer must be located in RAM and stay valid until the handler is called.
+ *
+ * @param[in]   addr      -   Device I2C address.
+ * @param[in]   reg       -   Register to read from.
+ * @param[in]   buffer    -   Pointer to received data.
+ * @param[in]   len       -   Length of buffer in bytes.
+ * @param[in]   handler   -   Completion handler, may be NULL.
+ * @param[in]   p_context -   Context passed to the handler.
+ *
+ * @retval  True if the transfer was queued.
+ */
+bool lsm303agr_read_continuous_async(uint8_t addr, uint8_t reg, uint8_t *buffer, uint16_t len, lsm303agr_xfer_handler_t handler,
+                                     void *p_context);
+
+/**@brief       Take exclusive ownership of the bus, e.g. for PPI triggered transfers.
+ *
+ * @note        Transfers queued while the bus is owned are held until lsm303agr_bus_release(),
+ *              blocking register accesses must not be issued by the owner.
+ *
+ * @retval  True if the bus was idle and is now owned by the caller.
+ */
+bool lsm303agr_bus_acquire(void);
+
+/**@brief       Release bus ownership and start held transfers.
  *
  */
-// bool lsm303agr_init(void);
+void lsm303agr_bus_release(void);
 
 /**@brief       Write buffer to LSM303AGR register.
  *
- * @param[in]   addr      -   TWI slave address.
+ * @param[in]   addr      -   Device I2C address.
  * @param[in]   reg       -   Register to write to.
  * @param[in]   buffer    -   Pointer to transferred data.
  * @param[in]   len       -   Length of buffer in bytes.
@@ -28,7 +129,7 @@ bool lsm303agr_write_buffer(uint8_t addr, uint8_t reg, uint8_t *buffer, uint16_t
 
 /**@brief       Write value to LSM303AGR register.
  *
- * @param[in]   addr      -   TWI slave address.
+ * @param[in]   addr      -   Device I2C address.
  * @param[in]   reg       -   Register to write to.
  * @param[in]   value     -   Value to write.
  *
@@ -38,7 +139,7 @@ bool lsm303agr_write_register(uint8_t addr, uint8_t reg, uint8_t value);
 
 /**@brief       Read value from LSM303AGR register.
  *
- * @param[in]   addr      -   TWI slave address.
+ * @param[in]   addr      -   Device I2C address.
  * @param[in]   reg       -   Register to read from.
  * @param[in]   buffer    -   Pointer to transferred data.
  * @param[in]   len       -   Length of buffer in bytes.
@@ -49,9 +150,9 @@ bool lsm303agr_read_continuous(uint8_t addr, uint8_t reg, uint8_t *buffer, uint1
 
 /**@brief       Read value from LSM303AGR register.
  *
- * @param[in]   addr      -   TWI slave address.
+ * @param[in]   addr      -   Device I2C address.
  * @param[in]   reg       -   Register to read from.
  *
  * @retval  Value from register.
  */
-uint8_t lsm303agr_read_register(uint8_t addr, uint8_t reg);
\ No newline at end of file
+uint8_t lsm303agr_read_register(uint8_t addr, uint8_t reg);
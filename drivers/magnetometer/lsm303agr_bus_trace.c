@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "lsm303agr_bus_trace.h"
+
+#include "app_timer.h"
+#include "app_util.h"
+#include "app_util_platform.h"
+#include "nrf_log_ctrl.h"
+
+#include <string.h>
+
+#define NRF_LOG_MODULE_NAME LSM303AGR_TRACE
+#define NRF_LOG_LEVEL 3 // LOG_LEVEL
+#include "nrfx_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define TRACE_MAGIC 0x42555354 // "BUST", ring content is valid.
+
+STATIC_ASSERT((LSM303AGR_BUS_TRACE_SIZE & (LSM303AGR_BUS_TRACE_SIZE - 1)) == 0);
+STATIC_ASSERT(sizeof(lsm303agr_bus_trace_rec_t) == 16);
+
+typedef struct {
+    uint32_t                  magic;       // TRACE_MAGIC if the ring survived a reset.
+    uint32_t                  index;       // Free running count of records.
+    uint32_t                  index_check; // Inverted index, detects random RAM after power on.
+    lsm303agr_bus_trace_rec_t rec[LSM303AGR_BUS_TRACE_SIZE];
+} bus_trace_t;
+
+// Not initialized by the startup code, retained over a soft reset.
+static bus_trace_t m_trace __attribute__((section(".non_init")));
+
+bool lsm303agr_bus_trace_init(void)
+{
+    if ((m_trace.magic == TRACE_MAGIC) && (m_trace.index_check == ~m_trace.index)) {
+        return m_trace.index != 0;
+    }
+
+    // Power on, RAM content is random.
+    memset(&m_trace, 0, sizeof(m_trace));
+    m_trace.index_check = ~m_trace.index;
+    m_trace.magic       = TRACE_MAGIC;
+
+    return false;
+}
+
+void lsm303agr_bus_trace_record(uint8_t addr, uint8_t reg, const uint8_t *p_data, uint16_t len, uint8_t flags)
+{
+    uint32_t index;
+
+    // Claim a slot, the record is filled outside the critical region.
+    CRITICAL_REGION_ENTER();
+    index               = m_trace.index++;
+    m_trace.index_check = ~m_trace.index;
+    CRITICAL_REGION_EXIT();
+
+    lsm303agr_bus_trace_rec_t *p_rec = &m_trace.rec[index % LSM303AGR_BUS_TRACE_SIZE];
+
+    p_rec->timestamp = app_timer_cnt_get();
+    p_rec->len       = len;
+    p_rec->addr      = addr;
+    p_rec->reg       = reg;
+    p_rec->flags     = flags;
+    memcpy(p_rec->data, p_data, MIN(len, LSM303AGR_BUS_TRACE_DATA));
+}
+
+bool lsm303agr_bus_trace_get(uint32_t age, lsm303agr_bus_trace_rec_t *p_rec)
+{
+    bool ret = false;
+
+    CRITICAL_REGION_ENTER();
+    if ((age < m_trace.index) && (age < LSM303AGR_BUS_TRACE_SIZE)) {
+        *p_rec = m_trace.rec[(m_trace.index - 1 - age) % LSM303AGR_BUS_TRACE_SIZE];
+        ret    = true;
+    }
+    CRITICAL_REGION_EXIT();
+
+    return ret;
+}
+
+void lsm303agr_bus_trace_dump(void)
+{
+    lsm303agr_bus_trace_rec_t rec;
+    uint32_t                  count = MIN(m_trace.index, LSM303AGR_BUS_TRACE_SIZE);
+
+    NRFX_LOG_INFO("Bus trace, %u of %u transactions:", count, m_trace.index);
+
+    for (uint32_t age = count; age-- > 0;) {
+        if (!lsm303agr_bus_trace_get(age, &rec)) {
+            continue;
+        }
+
+        NRFX_LOG_INFO("%u %s addr: 0x%x, register: 0x%x, len: %u %s", rec.timestamp,
+                      (rec.flags & LSM303AGR_BUS_TRACE_READ) ? "R" : "W", rec.addr, rec.reg, rec.len,
+                      (rec.flags & LSM303AGR_BUS_TRACE_OK) ? "ok" : "failed");
+        NRFX_LOG_HEXDUMP_INFO(rec.data, MIN(rec.len, LSM303AGR_BUS_TRACE_DATA));
+
+        // Deferred log buffer holds a few records only.
+        NRF_LOG_FLUSH();
+    }
+}
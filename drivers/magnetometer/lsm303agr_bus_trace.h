@@ -0,0 +1,59 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Records in the ring, power of two, the oldest record is overwritten. */
+#ifndef LSM303AGR_BUS_TRACE_SIZE
+#define LSM303AGR_BUS_TRACE_SIZE 64
+#endif
+
+/** Payload bytes kept per record, STATUS_REG_M..OUTZ_H_REG_M fits. */
+#define LSM303AGR_BUS_TRACE_DATA 7
+
+#define LSM303AGR_BUS_TRACE_READ (1 << 0) //!< Record of a read, a write otherwise.
+#define LSM303AGR_BUS_TRACE_OK (1 << 1)   //!< Transfer completed successfully.
+
+// Bus transaction record, 16 bytes.
+typedef struct {
+    uint32_t timestamp;                      // app_timer ticks at completion.
+    uint16_t len;                            // Payload length in bytes.
+    uint8_t  addr;                           // Device I2C address.
+    uint8_t  reg;                            // First register.
+    uint8_t  flags;                          // LSM303AGR_BUS_TRACE_* flags.
+    uint8_t  data[LSM303AGR_BUS_TRACE_DATA]; // First payload bytes.
+} lsm303agr_bus_trace_rec_t;
+
+/**@brief       Function for initializing the ring, records of the previous run are kept after a soft reset.
+ *
+ * @retval  True if records of the previous run were found.
+ */
+bool lsm303agr_bus_trace_init(void);
+
+/**@brief       Record a bus transaction, may be called from any priority.
+ *
+ * @param[in]   addr      -   Device I2C address.
+ * @param[in]   reg       -   First register.
+ * @param[in]   p_data    -   Payload.
+ * @param[in]   len       -   Payload length in bytes.
+ * @param[in]   flags     -   LSM303AGR_BUS_TRACE_* flags.
+ */
+void lsm303agr_bus_trace_record(uint8_t addr, uint8_t reg, const uint8_t *p_data, uint16_t len, uint8_t flags);
+
+/**@brief       Copy a record.
+ *
+ * @param[in]   age       -   0 for the newest record.
+ * @param[out]  p_rec     -   Record.
+ *
+ * @retval  True if the record exists.
+ */
+bool lsm303agr_bus_trace_get(uint32_t age, lsm303agr_bus_trace_rec_t *p_rec);
+
+/** Log all records, oldest first. */
+void lsm303agr_bus_trace_dump(void);
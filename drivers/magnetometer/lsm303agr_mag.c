@@ -7,10 +7,13 @@
 #include "lsm303agr_mag.h"
 
 #include "app_util.h"
+#include "app_util_platform.h"
 #include "lsm303agr.h"
 #include "nrf_delay.h"
 #include "nrf_log_ctrl.h"
 
+#include <string.h>
+
 #define NRF_LOG_MODULE_NAME LSM303AGR_MAG
 #define NRF_LOG_LEVEL 3 // LOG_LEVEL
 #include "nrfx_log.h"
@@ -19,8 +22,127 @@ NRF_LOG_MODULE_REGISTER();
 #define I2C_ADDR LSM303AGR_I2C_ADD_MG // Magnetometer I2C address.
 #define BOOT_TIME 5
 
+// Shadowed registers, consecutive entries with consecutive addresses can be accessed in one burst.
+typedef enum {
+    SHADOW_CFG_A = 0,
+    SHADOW_CFG_B,
+    SHADOW_CFG_C,
+    SHADOW_INT_CTRL,
+    SHADOW_INT_THS_L,
+    SHADOW_INT_THS_H,
+    SHADOW_COUNT,
+} shadow_index_t;
+
+typedef struct {
+    uint8_t value[SHADOW_COUNT]; // Last value written to / read from the device.
+    uint8_t valid;               // Bit per entry, value matches the device.
+    uint8_t dirty;               // Bit per entry, value was not written to the device yet.
+} shadow_t;
+
+static const uint8_t m_shadow_regs[SHADOW_COUNT] = {
+    [SHADOW_CFG_A]     = LSM303AGR_CFG_REG_A_M,
+    [SHADOW_CFG_B]     = LSM303AGR_CFG_REG_B_M,
+    [SHADOW_CFG_C]     = LSM303AGR_CFG_REG_C_M,
+    [SHADOW_INT_CTRL]  = LSM303AGR_INT_CTRL_REG_M,
+    [SHADOW_INT_THS_L] = LSM303AGR_INT_THS_L_REG_M,
+    [SHADOW_INT_THS_H] = LSM303AGR_INT_THS_H_REG_M,
+};
+
+static shadow_t                    m_shadow = {0};
+static lsm303agr_mag_cache_stats_t m_stats  = {0};
+
+static uint8_t shadow_mask(shadow_index_t first, uint8_t count) { return (uint8_t)(((1U << count) - 1) << first); }
+
+/**@brief       Set and clear shadow state bits, the cache is accessed from thread and interrupt context.
+ *
+ * @param[in]   p_bits    -   m_shadow.valid or m_shadow.dirty.
+ * @param[in]   set       -   Bits to set.
+ * @param[in]   clear     -   Bits to clear.
+ */
+static void shadow_bits_update(uint8_t *p_bits, uint8_t set, uint8_t clear)
+{
+    CRITICAL_REGION_ENTER();
+    *p_bits = (*p_bits | set) & ~clear;
+    CRITICAL_REGION_EXIT();
+}
+
+/**@brief       Read registers from the shadow copy, fetch them from the device in one burst if not valid.
+ *
+ * @param[in]   first     -   First shadow entry.
+ * @param[out]  p_values  -   Register values.
+ * @param[in]   count     -   Number of consecutive entries.
+ *
+ * @retval  True if values are available.
+ */
+static bool shadow_read(shadow_index_t first, uint8_t *p_values, uint8_t count)
+{
+    uint8_t mask = shadow_mask(first, count);
+
+    if ((m_shadow.valid & mask) == mask) {
+        // Served from RAM, one bus transaction saved.
+        m_stats.hits++;
+        memcpy(p_values, &m_shadow.value[first], count);
+        return true;
+    }
+
+    m_stats.misses++;
+    if (!lsm303agr_read_continuous(I2C_ADDR, m_shadow_regs[first], p_values, count)) {
+        return false;
+    }
+
+    memcpy(&m_shadow.value[first], p_values, count);
+    shadow_bits_update(&m_shadow.valid, mask, 0);
+    shadow_bits_update(&m_shadow.dirty, 0, mask);
+
+    return true;
+}
+
+/**@brief       Write registers through the shadow copy in one burst, skipped if the device already holds the values.
+ *
+ * @param[in]   first     -   First shadow entry.
+ * @param[in]   p_values  -   Register values.
+ * @param[in]   count     -   Number of consecutive entries.
+ *
+ * @retval  True if the device holds the values.
+ */
+static bool shadow_write(shadow_index_t first, const uint8_t *p_values, uint8_t count)
+{
+    uint8_t mask = shadow_mask(first, count);
+
+    if (((m_shadow.valid & mask) == mask) && ((m_shadow.dirty & mask) == 0) && (memcmp(&m_shadow.value[first], p_values, count) == 0)) {
+        m_stats.skipped++;
+        return true;
+    }
+
+    // Keep the requested values, a failed write stays dirty until flushed.
+    memcpy(&m_shadow.value[first], p_values, count);
+    shadow_bits_update(&m_shadow.valid, mask, 0);
+    shadow_bits_update(&m_shadow.dirty, mask, 0);
+
+    m_stats.writes++;
+    if (!lsm303agr_write_buffer(I2C_ADDR, m_shadow_regs[first], &m_shadow.value[first], count)) {
+        return false;
+    }
+
+    shadow_bits_update(&m_shadow.dirty, 0, mask);
+
+    // Single mode returns to idle by itself, the next access must not trust MD of the shadow.
+    if (mask & shadow_mask(SHADOW_CFG_A, 1)) {
+        lsm303agr_config_reg_a_t cfg_a = {.byte = m_shadow.value[SHADOW_CFG_A]};
+
+        if (cfg_a.MD == LSM303AGR_MODE_SINGLE) {
+            shadow_bits_update(&m_shadow.valid, 0, shadow_mask(SHADOW_CFG_A, 1));
+        }
+    }
+
+    return true;
+}
+
 bool lsm303agr_mag_init(void)
 {
+    // Nothing is known about the device registers yet.
+    lsm303agr_mag_cache_invalidate();
+
     // Wait for device boot time.
     nrf_delay_ms(BOOT_TIME);
 
@@ -42,16 +164,25 @@ bool lsm303agr_mag_set_soft_reset(lsm303agr_enable_t value)
 {
     lsm303agr_config_reg_a_t config;
 
-    config.byte     = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M);
+    if (!shadow_read(SHADOW_CFG_A, &config.byte, 1)) {
+        return false;
+    }
     config.SOFT_RST = value;
 
-    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M, config.byte);
+    m_stats.writes++;
+    bool ret = lsm303agr_write_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M, config.byte);
+
+    // Configuration and user registers are restored to default values.
+    lsm303agr_mag_cache_invalidate();
+
+    return ret;
 }
 
 lsm303agr_enable_t lsm303agr_mag_get_soft_reset(void)
 {
     lsm303agr_config_reg_a_t config;
 
+    // Self clearing bit, always read from the device.
     config.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M);
 
     return config.SOFT_RST;
@@ -61,16 +192,25 @@ bool lsm303agr_mag_set_reboot(lsm303agr_enable_t value)
 {
     lsm303agr_config_reg_a_t config;
 
-    config.byte   = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M);
+    if (!shadow_read(SHADOW_CFG_A, &config.byte, 1)) {
+        return false;
+    }
     config.REBOOT = value;
 
-    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M, config.byte);
+    m_stats.writes++;
+    bool ret = lsm303agr_write_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M, config.byte);
+
+    // Memory content is reloaded from the device.
+    lsm303agr_mag_cache_invalidate();
+
+    return ret;
 }
 
 lsm303agr_enable_t lsm303agr_mag_get_reboot(void)
 {
     lsm303agr_config_reg_a_t config;
 
+    // Self clearing bit, always read from the device.
     config.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M);
 
     return config.REBOOT;
@@ -80,17 +220,19 @@ bool lsm303agr_mag_set_comp_temp(lsm303agr_enable_t value)
 {
     lsm303agr_config_reg_a_t config;
 
-    config.byte         = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M);
+    if (!shadow_read(SHADOW_CFG_A, &config.byte, 1)) {
+        return false;
+    }
     config.COMP_TEMP_EN = value;
 
-    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M, config.byte);
+    return shadow_write(SHADOW_CFG_A, &config.byte, 1);
 }
 
 lsm303agr_enable_t lsm303agr_mag_get_comp_temp(void)
 {
-    lsm303agr_config_reg_a_t config;
+    lsm303agr_config_reg_a_t config = {0};
 
-    config.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M);
+    shadow_read(SHADOW_CFG_A, &config.byte, 1);
 
     return config.COMP_TEMP_EN;
 }
@@ -99,17 +241,19 @@ bool lsm303agr_mag_set_low_power(lsm303agr_enable_t value)
 {
     lsm303agr_config_reg_a_t config;
 
-    config.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M);
-    config.LP   = value;
+    if (!shadow_read(SHADOW_CFG_A, &config.byte, 1)) {
+        return false;
+    }
+    config.LP = value;
 
-    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M, config.byte);
+    return shadow_write(SHADOW_CFG_A, &config.byte, 1);
 }
 
-uint8_t lsm303agr_mag_get_low_power(void)
+lsm303agr_enable_t lsm303agr_mag_get_low_power(void)
 {
-    lsm303agr_config_reg_a_t config;
+    lsm303agr_config_reg_a_t config = {0};
 
-    config.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M);
+    shadow_read(SHADOW_CFG_A, &config.byte, 1);
 
     return config.LP;
 }
@@ -118,17 +262,19 @@ bool lsm303agr_mag_set_md(lsm303agr_md_t value)
 {
     lsm303agr_config_reg_a_t config;
 
-    config.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M);
-    config.MD   = value;
+    if (!shadow_read(SHADOW_CFG_A, &config.byte, 1)) {
+        return false;
+    }
+    config.MD = value;
 
-    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M, config.byte);
+    return shadow_write(SHADOW_CFG_A, &config.byte, 1);
 }
 
 lsm303agr_md_t lsm303agr_mag_get_md(void)
 {
-    lsm303agr_config_reg_a_t config;
+    lsm303agr_config_reg_a_t config = {0};
 
-    config.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M);
+    shadow_read(SHADOW_CFG_A, &config.byte, 1);
 
     return config.MD;
 }
@@ -137,17 +283,19 @@ bool lsm303agr_mag_set_odr(lsm303agr_odr_t value)
 {
     lsm303agr_config_reg_a_t config;
 
-    config.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M);
-    config.ODR  = value;
+    if (!shadow_read(SHADOW_CFG_A, &config.byte, 1)) {
+        return false;
+    }
+    config.ODR = value;
 
-    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M, config.byte);
+    return shadow_write(SHADOW_CFG_A, &config.byte, 1);
 }
 
-lsm303agr_odr_t lsm303ag_mag_get_odr(void)
+lsm303agr_odr_t lsm303agr_mag_get_odr(void)
 {
-    lsm303agr_config_reg_a_t config;
+    lsm303agr_config_reg_a_t config = {0};
 
-    config.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_A_M);
+    shadow_read(SHADOW_CFG_A, &config.byte, 1);
 
     return config.ODR;
 }
@@ -156,17 +304,19 @@ bool lsm303agr_mag_set_drdy_on_pin(lsm303agr_enable_t value)
 {
     lsm303agr_config_reg_c_t config;
 
-    config.byte    = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_C_M);
+    if (!shadow_read(SHADOW_CFG_C, &config.byte, 1)) {
+        return false;
+    }
     config.INT_MAG = value;
 
-    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CFG_REG_C_M, config.byte);
+    return shadow_write(SHADOW_CFG_C, &config.byte, 1);
 }
 
 lsm303agr_enable_t lsm303agr_mag_get_drdy_on_pin(void)
 {
-    lsm303agr_config_reg_c_t config;
+    lsm303agr_config_reg_c_t config = {0};
 
-    config.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_C_M);
+    shadow_read(SHADOW_CFG_C, &config.byte, 1);
 
     return config.INT_MAG;
 }
@@ -175,51 +325,93 @@ bool lsm303agr_mag_set_int_on_pin(lsm303agr_enable_t value)
 {
     lsm303agr_config_reg_c_t config;
 
-    config.byte        = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_C_M);
+    if (!shadow_read(SHADOW_CFG_C, &config.byte, 1)) {
+        return false;
+    }
     config.INT_MAG_PIN = value;
 
-    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CFG_REG_C_M, config.byte);
+    return shadow_write(SHADOW_CFG_C, &config.byte, 1);
 }
 
 lsm303agr_enable_t lsm303agr_mag_get_int_on_pin(void)
 {
-    lsm303agr_config_reg_c_t config;
+    lsm303agr_config_reg_c_t config = {0};
 
-    config.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_C_M);
+    shadow_read(SHADOW_CFG_C, &config.byte, 1);
 
     return config.INT_MAG_PIN;
 }
 
+bool lsm303agr_mag_set_bdu(lsm303agr_enable_t value)
+{
+    lsm303agr_config_reg_c_t config;
+
+    if (!shadow_read(SHADOW_CFG_C, &config.byte, 1)) {
+        return false;
+    }
+    config.BDU = value;
+
+    return shadow_write(SHADOW_CFG_C, &config.byte, 1);
+}
+
+lsm303agr_enable_t lsm303agr_mag_get_bdu(void)
+{
+    lsm303agr_config_reg_c_t config = {0};
+
+    shadow_read(SHADOW_CFG_C, &config.byte, 1);
+
+    return config.BDU;
+}
+
+bool lsm303agr_mag_set_ble(lsm303agr_enable_t value)
+{
+    lsm303agr_config_reg_c_t config;
+
+    if (!shadow_read(SHADOW_CFG_C, &config.byte, 1)) {
+        return false;
+    }
+    config.BLE = value;
+
+    return shadow_write(SHADOW_CFG_C, &config.byte, 1);
+}
+
+lsm303agr_enable_t lsm303agr_mag_get_ble(void)
+{
+    lsm303agr_config_reg_c_t config = {0};
+
+    shadow_read(SHADOW_CFG_C, &config.byte, 1);
+
+    return config.BLE;
+}
+
 bool lsm303agr_mag_set_set_rst_mode(lsm303agr_set_rst_t value)
 {
     lsm303agr_config_reg_b_t config;
 
-    config.byte    = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_B_M);
+    if (!shadow_read(SHADOW_CFG_B, &config.byte, 1)) {
+        return false;
+    }
     config.set_rst = value;
 
-    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CFG_REG_B_M, config.byte);
+    return shadow_write(SHADOW_CFG_B, &config.byte, 1);
 }
 
 lsm303agr_set_rst_t lsm303agr_mag_get_set_rst_mode(void)
 {
-    lsm303agr_config_reg_b_t config;
+    lsm303agr_config_reg_b_t config = {0};
 
-    config.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CFG_REG_B_M);
+    shadow_read(SHADOW_CFG_B, &config.byte, 1);
 
     return config.set_rst;
 }
 
-bool lsm303agr_mag_set_int_ctrl(lsm303agr_int_cntl_t value)
-{
-
-    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_INT_CTRL_REG_M, value.byte);
-}
+bool lsm303agr_mag_set_int_ctrl(lsm303agr_int_cntl_t value) { return shadow_write(SHADOW_INT_CTRL, &value.byte, 1); }
 
 lsm303agr_int_cntl_t lsm303agr_mag_get_int_ctrl(void)
 {
-    lsm303agr_int_cntl_t ret;
+    lsm303agr_int_cntl_t ret = {0};
 
-    ret.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_INT_CTRL_REG_M);
+    shadow_read(SHADOW_INT_CTRL, &ret.byte, 1);
 
     return ret;
 }
@@ -242,11 +434,11 @@ bool lsm303agr_mag_set_int_threshold(int16_t val)
 {
     uint8_t buff[2];
 
-    buff[0] = (val >> 0) && 0xFF;
-    buff[1] = (val >> 8) && 0xFF;
+    buff[0] = (val >> 0) & 0xFF;
+    buff[1] = (val >> 8) & 0xFF;
 
     // Write threshold registers.
-    return lsm303agr_write_buffer(I2C_ADDR, LSM303AGR_INT_THS_L_REG_M, buff, sizeof(buff));
+    return shadow_write(SHADOW_INT_THS_L, buff, sizeof(buff));
 }
 
 int16_t lsm303agr_mag_get_int_threshold(void)
@@ -254,7 +446,131 @@ int16_t lsm303agr_mag_get_int_threshold(void)
     uint8_t buff[2] = {0};
 
     // Read ths registers.
-    lsm303agr_read_continuous(I2C_ADDR, LSM303AGR_INT_THS_L_REG_M, buff, sizeof(buff));
+    shadow_read(SHADOW_INT_THS_L, buff, sizeof(buff));
 
     return (int16_t)((buff[1] << 8) + buff[0]);
-}
\ No newline at end of file
+}
+
+lsm303agr_status_reg_t lsm303agr_mag_get_status(void)
+{
+    lsm303agr_status_reg_t ret;
+
+    ret.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_STATUS_REG_M);
+
+    return ret;
+}
+
+bool lsm303agr_mag_read_raw(lsm303agr_mag_raw_t *p_raw)
+{
+    // Output registers are auto-incremented, bytes land in CPU order with BLE = LSM303AGR_MAG_BLE_NATIVE.
+    return lsm303agr_read_continuous(I2C_ADDR, LSM303AGR_OUTX_L_REG_M, p_raw->byte, sizeof(p_raw->byte));
+}
+
+bool lsm303agr_mag_read_xyz(lsm303agr_mag_sample_t *p_sample)
+{
+    STATIC_ASSERT(sizeof(lsm303agr_mag_sample_t) == (LSM303AGR_OUTZ_H_REG_M - LSM303AGR_STATUS_REG_M + 1));
+
+    // STATUS_REG_M is followed by the output registers.
+    return lsm303agr_read_continuous(I2C_ADDR, LSM303AGR_STATUS_REG_M, (uint8_t *)p_sample, sizeof(*p_sample));
+}
+
+bool lsm303agr_mag_set_offset(const lsm303agr_mag_raw_t *p_offset)
+{
+    uint8_t buff[6];
+
+    // Offset registers are always little endian, BLE only swaps the output registers.
+    for (uint8_t i = 0; i < 3; i++) {
+        buff[2 * i]     = (p_offset->axis[i] >> 0) & 0xFF;
+        buff[2 * i + 1] = (p_offset->axis[i] >> 8) & 0xFF;
+    }
+
+    return lsm303agr_write_buffer(I2C_ADDR, LSM303AGR_OFFSET_X_REG_L_M, buff, sizeof(buff));
+}
+
+bool lsm303agr_mag_get_offset(lsm303agr_mag_raw_t *p_offset)
+{
+    uint8_t buff[6];
+
+    if (!lsm303agr_read_continuous(I2C_ADDR, LSM303AGR_OFFSET_X_REG_L_M, buff, sizeof(buff))) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < 3; i++) {
+        p_offset->axis[i] = (int16_t)((buff[2 * i + 1] << 8) + buff[2 * i]);
+    }
+
+    return true;
+}
+
+bool lsm303agr_mag_read_int_source(lsm303agr_int_source_t *p_source)
+{
+    return lsm303agr_read_continuous(I2C_ADDR, LSM303AGR_INT_SOURCE_REG_M, &p_source->byte, sizeof(p_source->byte));
+}
+
+bool lsm303agr_mag_apply_config(const lsm303agr_mag_config_t *p_config, bool verify)
+{
+    lsm303agr_config_reg_a_t cfg_a = {.MD = p_config->md, .ODR = p_config->odr, .LP = p_config->lp, .COMP_TEMP_EN = p_config->comp_temp};
+    lsm303agr_config_reg_b_t cfg_b = {.lpf = p_config->lpf, .set_rst = p_config->set_rst, .int_on_dataoff = p_config->int_on_dataoff};
+    lsm303agr_config_reg_c_t cfg_c = {
+        .INT_MAG_PIN = p_config->int_on_pin, .INT_MAG = p_config->drdy_on_pin, .BDU = p_config->bdu, .BLE = p_config->ble,
+        .I2C_DIS = p_config->i2c_dis};
+
+    // INT_SOURCE_REG_M (read only) splits the block, thresholds go first so the interrupt is enabled with them.
+    uint8_t ths[2]  = {(p_config->int_threshold >> 0) & 0xFF, (p_config->int_threshold >> 8) & 0xFF};
+    uint8_t regs[4] = {cfg_a.byte, cfg_b.byte, cfg_c.byte, p_config->int_ctrl.byte};
+
+    if (!shadow_write(SHADOW_INT_THS_L, ths, sizeof(ths)) || !shadow_write(SHADOW_CFG_A, regs, sizeof(regs))) {
+        NRFX_LOG_WARNING("%s Configuration write failed.", __func__);
+        return false;
+    }
+
+    if (!verify) {
+        return true;
+    }
+
+    uint8_t readback_ths[2];
+    uint8_t readback_regs[4];
+
+    // Read back from the device, bypassing the shadow.
+    if (!lsm303agr_read_continuous(I2C_ADDR, LSM303AGR_INT_THS_L_REG_M, readback_ths, sizeof(readback_ths)) ||
+        !lsm303agr_read_continuous(I2C_ADDR, LSM303AGR_CFG_REG_A_M, readback_regs, sizeof(readback_regs))) {
+        lsm303agr_mag_cache_invalidate();
+        return false;
+    }
+
+    if ((memcmp(ths, readback_ths, sizeof(ths)) != 0) || (memcmp(regs, readback_regs, sizeof(regs)) != 0)) {
+        NRFX_LOG_WARNING("%s Configuration readback mismatch.", __func__);
+        lsm303agr_mag_cache_invalidate();
+        return false;
+    }
+
+    return true;
+}
+
+void lsm303agr_mag_cache_invalidate(void)
+{
+    CRITICAL_REGION_ENTER();
+    m_shadow.valid = 0;
+    m_shadow.dirty = 0;
+    CRITICAL_REGION_EXIT();
+}
+
+bool lsm303agr_mag_cache_flush(void)
+{
+    bool ret = true;
+
+    for (shadow_index_t index = SHADOW_CFG_A; index < SHADOW_COUNT; index++) {
+        if (m_shadow.dirty & shadow_mask(index, 1)) {
+            m_stats.writes++;
+            if (lsm303agr_write_register(I2C_ADDR, m_shadow_regs[index], m_shadow.value[index])) {
+                shadow_bits_update(&m_shadow.dirty, 0, shadow_mask(index, 1));
+            } else {
+                ret = false;
+            }
+        }
+    }
+
+    return ret;
+}
+
+void lsm303agr_mag_get_cache_stats(lsm303agr_mag_cache_stats_t *p_stats) { *p_stats = m_stats; }
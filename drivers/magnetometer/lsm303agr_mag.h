@@ -8,6 +8,39 @@
 
 #include "lsm303agr_types.h"
 
+/** BLE setting placing output bytes in CPU order, the device default is little endian. */
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define LSM303AGR_MAG_BLE_NATIVE LSM303AGR_ENABLE
+#else
+#define LSM303AGR_MAG_BLE_NATIVE LSM303AGR_DISABLE
+#endif
+
+// Shadow register cache statistics.
+typedef struct {
+    uint32_t hits;    // Register reads served from RAM, each one saves a bus transaction.
+    uint32_t misses;  // Register reads fetched from the device.
+    uint32_t writes;  // Register write transactions.
+    uint32_t skipped; // Register writes skipped because the device already holds the value.
+} lsm303agr_mag_cache_stats_t;
+
+// Magnetometer configuration profile, applied with lsm303agr_mag_apply_config().
+typedef struct {
+    lsm303agr_md_t       md;             // Mode select.
+    lsm303agr_odr_t      odr;            // Output data rate.
+    lsm303agr_lp_t       lp;             // Low-power mode.
+    lsm303agr_enable_t   comp_temp;      // Temperature compensation, must be enabled for proper operation.
+    lsm303agr_enable_t   lpf;            // Digital low-pass filter.
+    lsm303agr_set_rst_t  set_rst;        // Set pulse and offset cancellation mode.
+    lsm303agr_int_cntl_t int_ctrl;       // Interrupt control.
+    int16_t              int_threshold;  // Interrupt threshold [LSB].
+    lsm303agr_enable_t   int_on_dataoff; // Comparator checks the output after the hard-iron offset is subtracted.
+    lsm303agr_enable_t   int_on_pin;     // Interrupt signal driven on INT_MAG_PIN.
+    lsm303agr_enable_t   drdy_on_pin;    // DRDY pin configured as a digital output.
+    lsm303agr_enable_t   bdu;            // Block data update, output registers hold until both bytes are read.
+    lsm303agr_enable_t   ble;            // Big/little endian data inversion, see LSM303AGR_MAG_BLE_NATIVE.
+    lsm303agr_enable_t   i2c_dis;        // I2C interface inhibited, set when the device is on the SPI bus.
+} lsm303agr_mag_config_t;
+
 /** Initializing LSM303AGR magnetometer device.*/
 bool lsm303agr_mag_init(void);
 
@@ -38,6 +71,10 @@ lsm303agr_md_t lsm303agr_mag_get_md(void);
 bool            lsm303agr_mag_set_odr(lsm303agr_odr_t value);
 lsm303agr_odr_t lsm303agr_mag_get_odr(void);
 
+/** Set pulse and offset cancellation configuration. */
+bool                lsm303agr_mag_set_set_rst_mode(lsm303agr_set_rst_t value);
+lsm303agr_set_rst_t lsm303agr_mag_get_set_rst_mode(void);
+
 /** DRDY pin digital output configuration. */
 bool               lsm303agr_mag_set_drdy_on_pin(lsm303agr_enable_t value);
 lsm303agr_enable_t lsm303agr_mag_get_drdy_on_pin(void);
@@ -46,6 +83,14 @@ lsm303agr_enable_t lsm303agr_mag_get_drdy_on_pin(void);
 bool               lsm303agr_mag_set_int_on_pin(lsm303agr_enable_t value);
 lsm303agr_enable_t lsm303agr_mag_get_int_on_pin(void);
 
+/** Block data update. */
+bool               lsm303agr_mag_set_bdu(lsm303agr_enable_t value);
+lsm303agr_enable_t lsm303agr_mag_get_bdu(void);
+
+/** Big/little endian data selection. */
+bool               lsm303agr_mag_set_ble(lsm303agr_enable_t value);
+lsm303agr_enable_t lsm303agr_mag_get_ble(void);
+
 /** Interrupt signal driven on INT_MAG_PIN configuration. */
 bool                 lsm303agr_mag_set_int_ctrl(lsm303agr_int_cntl_t value);
 lsm303agr_int_cntl_t lsm303agr_mag_get_int_ctrl(void);
@@ -56,4 +101,32 @@ lsm303agr_int_source_t lsm303agr_mag_get_int_source(void);
 
 /** Interrupt threshold registers */
 bool    lsm303agr_mag_set_int_threshold(int16_t val);
-int16_t lsm303agr_mag_get_int_threshold(void);
\ No newline at end of file
+int16_t lsm303agr_mag_get_int_threshold(void);
+
+/** Status register, data ready and overrun flags. */
+lsm303agr_status_reg_t lsm303agr_mag_get_status(void);
+
+/** Read X, Y and Z output in one 6 bytes burst. */
+bool lsm303agr_mag_read_raw(lsm303agr_mag_raw_t *p_raw);
+
+/** Read status and X, Y and Z output in one 7 bytes burst. */
+bool lsm303agr_mag_read_xyz(lsm303agr_mag_sample_t *p_sample);
+
+/** Hard-iron offset subtracted from the output before the threshold comparator, one 6 bytes burst. */
+bool lsm303agr_mag_set_offset(const lsm303agr_mag_raw_t *p_offset);
+bool lsm303agr_mag_get_offset(lsm303agr_mag_raw_t *p_offset);
+
+/** Read interrupt source in one byte, also clears a latched interrupt. */
+bool lsm303agr_mag_read_int_source(lsm303agr_int_source_t *p_source);
+
+/** Forget the shadow copy of CFG_REG_A/B/C, INT_CTRL and INT_THS, the next access reads the device. */
+void lsm303agr_mag_cache_invalidate(void);
+
+/** Write shadowed registers whose last write failed. */
+bool lsm303agr_mag_cache_flush(void);
+
+/** Shadow register cache statistics. */
+void lsm303agr_mag_get_cache_stats(lsm303agr_mag_cache_stats_t *p_stats);
+
+/** Apply configuration profile, CFG_REG_A..INT_CTRL and INT_THS are written in two burst transfers. */
+bool lsm303agr_mag_apply_config(const lsm303agr_mag_config_t *p_config, bool verify);
@@ -0,0 +1,162 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "lsm303agr_mag_stream.h"
+
+#include "app_error.h"
+#include "app_util.h"
+#include "lsm303agr_twim.h"
+#include "nrf_delay.h"
+#include "nrf_gpio.h"
+#include "nrfx_ppi.h"
+#include "nrfx_timer.h"
+#include "nrfx_twim.h"
+
+#define NRF_LOG_MODULE_NAME LSM303AGR_STREAM
+#define NRF_LOG_LEVEL 3 // LOG_LEVEL
+#include "nrfx_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define I2C_ADDR LSM303AGR_I2C_ADD_MG // Magnetometer I2C address.
+#define HALF_DEPTH (LSM303AGR_MAG_STREAM_DEPTH / 2)
+#define XFER_TIME_US 500 // Upper bound of one 1+6 bytes transaction at 400 kHz.
+
+STATIC_ASSERT((LSM303AGR_MAG_STREAM_DEPTH % 2) == 0);
+
+static const nrfx_timer_t m_timer = NRFX_TIMER_INSTANCE(LSM303AGR_MAG_STREAM_TIMER_INST);
+
+static lsm303agr_mag_raw_t            m_ring[LSM303AGR_MAG_STREAM_DEPTH]; // EasyDMA ArrayList destination.
+static uint8_t                        m_reg = LSM303AGR_OUTX_L_REG_M;     // TX buffer, first output register.
+static const nrfx_twim_t             *mp_twim = NULL;                      // TWIM instance of the bus.
+static nrf_ppi_channel_t              m_ppi_drdy;                         // DRDY event -> TWIM STARTTX.
+static nrf_ppi_channel_t              m_ppi_count;                        // TWIM STOPPED -> TIMER COUNT.
+static lsm303agr_mag_stream_handler_t m_handler = NULL;
+static bool                           m_running = false;
+
+static void stream_timer_handler(nrf_timer_event_t event_type, void *p_context)
+{
+    switch (event_type) {
+    case NRF_TIMER_EVENT_COMPARE0:
+        // First half is complete, DMA continues into the second half.
+        m_handler(&m_ring[0], HALF_DEPTH);
+        break;
+    case NRF_TIMER_EVENT_COMPARE1:
+        // Ring is complete and the counter is cleared, rewind DMA before the next DRDY.
+        nrf_twim_rx_buffer_set(mp_twim->p_twim, (uint8_t *)&m_ring[0], sizeof(m_ring[0]));
+        m_handler(&m_ring[HALF_DEPTH], HALF_DEPTH);
+        break;
+    default:
+        break;
+    }
+}
+
+bool lsm303agr_mag_stream_start(uint32_t drdy_event_addr, uint32_t drdy_pin, lsm303agr_mag_stream_handler_t handler)
+{
+    nrfx_err_t err_code;
+
+    ASSERT(handler);
+
+    if (m_running) {
+        return false;
+    }
+
+    // DRDY triggers a TWIM task, there is no SPIM equivalent with per-device chip select.
+    if ((lsm303agr_bus_get() == NULL) || (lsm303agr_bus_get()->type != LSM303AGR_BUS_TWIM)) {
+        NRFX_LOG_WARNING("%s Streaming requires the TWIM bus.", __func__);
+        return false;
+    }
+
+    // PPI transfers bypass the transfer queue.
+    if (!lsm303agr_bus_acquire()) {
+        NRFX_LOG_WARNING("%s TWIM bus is busy.", __func__);
+        return false;
+    }
+
+    m_handler = handler;
+    mp_twim   = lsm303agr_twim_instance_get();
+
+    // Transfer is armed once and restarted by hardware, RXD.PTR advances by one sample after each transfer.
+    nrfx_twim_xfer_desc_t xfer = NRFX_TWIM_XFER_DESC_TXRX(I2C_ADDR, &m_reg, sizeof(m_reg), (uint8_t *)&m_ring[0], sizeof(m_ring[0]));
+    err_code                   = nrfx_twim_xfer(mp_twim, &xfer,
+                                                NRFX_TWIM_FLAG_HOLD_XFER | NRFX_TWIM_FLAG_RX_POSTINC | NRFX_TWIM_FLAG_REPEATED_XFER |
+                                                    NRFX_TWIM_FLAG_NO_XFER_EVT_HANDLER);
+    if (err_code != NRFX_SUCCESS) {
+        NRFX_LOG_WARNING("%s Transfer setup failed error: 0x%x.", __func__, err_code);
+        lsm303agr_bus_release();
+        return false;
+    }
+
+    // Count completed transfers, wake up every half ring.
+    nrfx_timer_config_t timer_config = NRFX_TIMER_DEFAULT_CONFIG;
+    timer_config.mode                = NRF_TIMER_MODE_COUNTER;
+    timer_config.bit_width           = NRF_TIMER_BIT_WIDTH_16;
+
+    err_code = nrfx_timer_init(&m_timer, &timer_config, stream_timer_handler);
+    APP_ERROR_CHECK(err_code);
+
+    nrfx_timer_compare(&m_timer, NRF_TIMER_CC_CHANNEL0, HALF_DEPTH, true);
+    nrfx_timer_extended_compare(&m_timer, NRF_TIMER_CC_CHANNEL1, LSM303AGR_MAG_STREAM_DEPTH, NRF_TIMER_SHORT_COMPARE1_CLEAR_MASK, true);
+
+    err_code = nrfx_ppi_channel_alloc(&m_ppi_drdy);
+    APP_ERROR_CHECK(err_code);
+    err_code = nrfx_ppi_channel_alloc(&m_ppi_count);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrfx_ppi_channel_assign(m_ppi_drdy, drdy_event_addr, nrfx_twim_start_task_get(mp_twim, NRFX_TWIM_XFER_TXRX));
+    APP_ERROR_CHECK(err_code);
+    err_code = nrfx_ppi_channel_assign(m_ppi_count, nrfx_twim_stopped_event_get(mp_twim),
+                                       nrfx_timer_task_address_get(&m_timer, NRF_TIMER_TASK_COUNT));
+    APP_ERROR_CHECK(err_code);
+
+    nrfx_timer_enable(&m_timer);
+    nrfx_ppi_channel_enable(m_ppi_count);
+    nrfx_ppi_channel_enable(m_ppi_drdy);
+
+    m_running = true;
+
+    // DRDY stays high until the output is read, a sample pending from before would never produce an edge.
+    if (nrf_gpio_pin_read(drdy_pin)) {
+        nrf_twim_task_trigger(mp_twim->p_twim, NRF_TWIM_TASK_STARTTX);
+    }
+
+    return true;
+}
+
+void lsm303agr_mag_stream_stop(void)
+{
+    if (!m_running) {
+        return;
+    }
+
+    nrfx_ppi_channel_disable(m_ppi_drdy);
+
+    // Let a transfer already on the bus finish and be counted.
+    nrf_delay_us(XFER_TIME_US);
+
+    nrfx_ppi_channel_disable(m_ppi_count);
+
+    // Deliver samples of the current half ring from the caller, counting is stopped so no TIMER interrupt follows.
+    uint32_t count = nrfx_timer_capture(&m_timer, NRF_TIMER_CC_CHANNEL2);
+    if (count > HALF_DEPTH) {
+        m_handler(&m_ring[HALF_DEPTH], count - HALF_DEPTH);
+    } else if (count > 0) {
+        m_handler(&m_ring[0], count);
+    }
+
+    nrfx_timer_disable(&m_timer);
+    nrfx_timer_uninit(&m_timer);
+
+    UNUSED_RETURN_VALUE(nrfx_ppi_channel_free(m_ppi_drdy));
+    UNUSED_RETURN_VALUE(nrfx_ppi_channel_free(m_ppi_count));
+
+    // Restore single buffer RX for queued transfers.
+    nrf_twim_rx_list_disable(mp_twim->p_twim);
+
+    m_running = false;
+    lsm303agr_bus_release();
+}
+
+bool lsm303agr_mag_stream_is_running(void) { return m_running; }
@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include "lsm303agr_types.h"
+
+/** Number of samples in the RAM ring, the handler is called every half ring. */
+#ifndef LSM303AGR_MAG_STREAM_DEPTH
+#define LSM303AGR_MAG_STREAM_DEPTH 20
+#endif
+
+/** TIMER instance counting completed transfers. */
+#ifndef LSM303AGR_MAG_STREAM_TIMER_INST
+#define LSM303AGR_MAG_STREAM_TIMER_INST 1
+#endif
+
+/**@brief       Stream samples handler, called from TIMER interrupt context for every half ring.
+ *
+ * @note        Samples are overwritten half a ring later, copy them out before that. The samples of the last,
+ *              incomplete half ring are delivered by lsm303agr_mag_stream_stop() from the context of its caller.
+ *
+ * @param[in]   p_samples -   Samples in acquisition order.
+ * @param[in]   count     -   Number of samples.
+ */
+typedef void (*lsm303agr_mag_stream_handler_t)(const lsm303agr_mag_raw_t *p_samples, uint16_t count);
+
+/**@brief       Start hardware acquisition, DRDY rising edge triggers an OUTX_L..OUTZ_H read through PPI.
+ *
+ * @note        The device must be configured with DRDY on its pin, and the GPIOTE IN event of the pin must be
+ *              configured as low to high and enabled by the caller. Requires the TWIM bus, which is owned until stopped.
+ *
+ * @param[in]   drdy_event_addr -   Address of the GPIOTE IN event of the DRDY pin.
+ * @param[in]   drdy_pin        -   DRDY pin, used to catch up on a sample already pending.
+ * @param[in]   handler         -   Samples handler.
+ *
+ * @retval  True if acquisition started.
+ */
+bool lsm303agr_mag_stream_start(uint32_t drdy_event_addr, uint32_t drdy_pin, lsm303agr_mag_stream_handler_t handler);
+
+/**@brief       Stop hardware acquisition, samples of the current half ring are delivered to the handler before it
+ *              returns, from the caller's context.
+ *
+ */
+void lsm303agr_mag_stream_stop(void);
+
+/** True if hardware acquisition is running. */
+bool lsm303agr_mag_stream_is_running(void);
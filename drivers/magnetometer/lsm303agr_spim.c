@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "lsm303agr_spim.h"
+
+#include "nrf_gpio.h"
+
+#define NRF_LOG_MODULE_NAME LSM303AGR_SPIM
+#define NRF_LOG_LEVEL 3 // LOG_LEVEL
+#include "nrfx_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define SPI_READ 0x80           // First byte MSB, 1 for read.
+#define SPI_ADDR_MASK 0x7F      // Register address AD(6:0), the I2C auto-increment flag is dropped.
+#define SPI_XL_ADDR_MASK 0x3F   // Accelerometer register address AD(5:0).
+#define SPI_XL_MS 0x40          // Accelerometer address auto-increment, the magnetometer always increments.
+#define I2C_AUTO_INCREMENT 0x80 // Sub-address MSB of the accelerometer, as lsm303agr_xl.c.
+
+static const nrfx_spim_t *mp_spim = NULL;
+static uint32_t           m_cs_xl_pin;
+static uint32_t           m_cs_mag_pin;
+
+static uint32_t m_cs_pin;        // Chip select of the transfer on the bus.
+static uint8_t  m_cmd;           // Read command byte.
+static uint8_t *mp_rx    = NULL; // Data phase of a read is pending.
+static uint16_t m_rx_len = 0;
+
+/**@brief       Command byte of a register access, without the read bit.
+ *
+ * @param[in]   addr      -   Device I2C address.
+ * @param[in]   reg       -   Register address as given for I2C.
+ *
+ * @retval  AD(6:0) of the magnetometer, MS and AD(5:0) of the accelerometer.
+ */
+static uint8_t spim_cmd(uint8_t addr, uint8_t reg)
+{
+    // Magnetometer registers start at 0x40, bit 6 is part of their address.
+    if (addr == LSM303AGR_I2C_ADD_MG) {
+        return reg & SPI_ADDR_MASK;
+    }
+
+    return (reg & SPI_XL_ADDR_MASK) | ((reg & I2C_AUTO_INCREMENT) ? SPI_XL_MS : 0);
+}
+
+static nrfx_err_t spim_xfer_start(uint8_t addr, uint8_t *p_tx, uint16_t tx_len)
+{
+    m_cs_pin = (addr == LSM303AGR_I2C_ADD_MG) ? m_cs_mag_pin : m_cs_xl_pin;
+
+    // Chip select is held low across both phases of a read.
+    nrf_gpio_pin_clear(m_cs_pin);
+
+    nrfx_spim_xfer_desc_t xfer     = NRFX_SPIM_XFER_TX(p_tx, tx_len);
+    nrfx_err_t            err_code = nrfx_spim_xfer(mp_spim, &xfer, 0);
+    if (err_code != NRFX_SUCCESS) {
+        nrf_gpio_pin_set(m_cs_pin);
+    }
+
+    return err_code;
+}
+
+static nrfx_err_t spim_write(uint8_t addr, uint8_t *p_tx, uint16_t len)
+{
+    // Command and payload in a single transaction.
+    p_tx[0] = spim_cmd(addr, p_tx[0]);
+    mp_rx = NULL;
+
+    return spim_xfer_start(addr, p_tx, 1 + len);
+}
+
+static nrfx_err_t spim_read(uint8_t addr, uint8_t *p_tx, uint8_t *p_rx, uint16_t len)
+{
+    // SDIO is turned around after the command, the payload is clocked in by a second transaction.
+    m_cmd    = spim_cmd(addr, p_tx[0]) | SPI_READ;
+    mp_rx    = p_rx;
+    m_rx_len = len;
+
+    nrfx_err_t err_code = spim_xfer_start(addr, &m_cmd, sizeof(m_cmd));
+    if (err_code != NRFX_SUCCESS) {
+        mp_rx = NULL;
+    }
+
+    return err_code;
+}
+
+static const lsm303agr_bus_t m_spim_bus = {
+    .type  = LSM303AGR_BUS_SPIM,
+    .write = spim_write,
+    .read  = spim_read,
+};
+
+const lsm303agr_bus_t *lsm303agr_spim_bus(const nrfx_spim_t *p_spim, uint32_t cs_xl_pin, uint32_t cs_mag_pin)
+{
+    mp_spim      = p_spim;
+    m_cs_xl_pin  = cs_xl_pin;
+    m_cs_mag_pin = cs_mag_pin;
+
+    // Both devices deselected.
+    nrf_gpio_pin_set(m_cs_xl_pin);
+    nrf_gpio_cfg_output(m_cs_xl_pin);
+    nrf_gpio_pin_set(m_cs_mag_pin);
+    nrf_gpio_cfg_output(m_cs_mag_pin);
+
+    return &m_spim_bus;
+}
+
+void lsm303agr_spim_event_handler(nrfx_spim_evt_t const *p_event, void *p_context)
+{
+    if (mp_rx != NULL) {
+        // Command is sent, receive the payload.
+        nrfx_spim_xfer_desc_t xfer = NRFX_SPIM_XFER_RX(mp_rx, m_rx_len);
+
+        mp_rx = NULL;
+        if (nrfx_spim_xfer(mp_spim, &xfer, 0) == NRFX_SUCCESS) {
+            return;
+        }
+
+        NRFX_LOG_WARNING("%s Data phase start failed.", __func__);
+        nrf_gpio_pin_set(m_cs_pin);
+        lsm303agr_bus_xfer_done(false);
+        return;
+    }
+
+    nrf_gpio_pin_set(m_cs_pin);
+    lsm303agr_bus_xfer_done(true);
+}
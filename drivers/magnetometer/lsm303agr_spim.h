@@ -0,0 +1,32 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include "lsm303agr.h"
+#include "nrfx_spim.h"
+
+/**@brief       Get the 3-wire SPI bus operations.
+ *
+ * @note        The LSM303AGR SPI is 3-wire (SDIO), MISO is connected to SDIO directly and MOSI through a series
+ *              resistor (~1 kOhm) so the device can drive SDIO during the data phase of a read.
+ *              The instance must be initialized in non-blocking mode, SPI mode 3, up to 8 MHz, without SS pin,
+ *              with lsm303agr_spim_event_handler(). Chip select of each device is driven by the backend.
+ *
+ * @param[in]   p_spim     -   SPIM driver instance.
+ * @param[in]   cs_xl_pin  -   Accelerometer chip select (CS_A) pin.
+ * @param[in]   cs_mag_pin -   Magnetometer chip select (CS_M) pin.
+ *
+ * @retval  Bus operations for lsm303agr_init().
+ */
+const lsm303agr_bus_t *lsm303agr_spim_bus(const nrfx_spim_t *p_spim, uint32_t cs_xl_pin, uint32_t cs_mag_pin);
+
+/**@brief       SPIM event handler, must be passed to nrfx_spim_init() for the LSM303AGR bus.
+ *
+ * @param[in]   p_event   -   SPIM driver event.
+ * @param[in]   p_context -   Unused.
+ */
+void lsm303agr_spim_event_handler(nrfx_spim_evt_t const *p_event, void *p_context);
@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "lsm303agr_twim.h"
+
+#define NRF_LOG_MODULE_NAME LSM303AGR_TWIM
+#define NRF_LOG_LEVEL 3 // LOG_LEVEL
+#include "nrfx_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+static const nrfx_twim_t *mp_twim = NULL;
+
+static nrfx_err_t twim_write(uint8_t addr, uint8_t *p_tx, uint16_t len)
+{
+    // Register address and payload in a single transaction.
+    nrfx_twim_xfer_desc_t xfer = NRFX_TWIM_XFER_DESC_TX(addr, p_tx, 1 + len);
+
+    return nrfx_twim_xfer(mp_twim, &xfer, 0);
+}
+
+static nrfx_err_t twim_read(uint8_t addr, uint8_t *p_tx, uint8_t *p_rx, uint16_t len)
+{
+    // Register address, repeated START and payload in a single transaction.
+    nrfx_twim_xfer_desc_t xfer = NRFX_TWIM_XFER_DESC_TXRX(addr, p_tx, 1, p_rx, len);
+
+    return nrfx_twim_xfer(mp_twim, &xfer, 0);
+}
+
+static const lsm303agr_bus_t m_twim_bus = {
+    .type  = LSM303AGR_BUS_TWIM,
+    .write = twim_write,
+    .read  = twim_read,
+};
+
+const lsm303agr_bus_t *lsm303agr_twim_bus(const nrfx_twim_t *p_twim)
+{
+    mp_twim = p_twim;
+
+    return &m_twim_bus;
+}
+
+const nrfx_twim_t *lsm303agr_twim_instance_get(void) { return mp_twim; }
+
+void lsm303agr_twim_event_handler(nrfx_twim_evt_t const *p_event, void *p_context)
+{
+    if (p_event->type != NRFX_TWIM_EVT_DONE) {
+        NRFX_LOG_WARNING("%s Transfer failed event: %d.", __func__, p_event->type);
+    }
+
+    lsm303agr_bus_xfer_done(p_event->type == NRFX_TWIM_EVT_DONE);
+}
@@ -0,0 +1,30 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include "lsm303agr.h"
+#include "nrfx_twim.h"
+
+/**@brief       Get the TWIM bus operations.
+ *
+ * @note        The instance must be initialized in non-blocking mode with lsm303agr_twim_event_handler().
+ *
+ * @param[in]   p_twim    -   TWIM driver instance.
+ *
+ * @retval  Bus operations for lsm303agr_init().
+ */
+const lsm303agr_bus_t *lsm303agr_twim_bus(const nrfx_twim_t *p_twim);
+
+/** TWIM driver instance of the bus, NULL if the bus is not initialized. */
+const nrfx_twim_t *lsm303agr_twim_instance_get(void);
+
+/**@brief       TWIM event handler, must be passed to nrfx_twim_init() for the LSM303AGR bus.
+ *
+ * @param[in]   p_event   -   TWIM driver event.
+ * @param[in]   p_context -   Unused.
+ */
+void lsm303agr_twim_event_handler(nrfx_twim_evt_t const *p_event, void *p_context);
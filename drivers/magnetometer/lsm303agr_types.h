@@ -26,6 +26,35 @@ typedef enum {
     LSM303AGR_WHO_AM_I_A = 0x0F,
     LSM303AGR_WHO_AM_I_M = 0x4F,
 
+    // Accelerometer temperature registers
+    LSM303AGR_STATUS_REG_AUX_A = 0x07,
+    LSM303AGR_OUT_TEMP_L_A     = 0x0C,
+    LSM303AGR_OUT_TEMP_H_A     = 0x0D,
+    LSM303AGR_TEMP_CFG_REG_A   = 0x1F,
+
+    // Accelerometer configuration registers
+    LSM303AGR_CTRL_REG1_A = 0x20,
+    LSM303AGR_CTRL_REG2_A = 0x21,
+    LSM303AGR_CTRL_REG3_A = 0x22,
+    LSM303AGR_CTRL_REG4_A = 0x23,
+    LSM303AGR_CTRL_REG5_A = 0x24,
+    LSM303AGR_CTRL_REG6_A = 0x25,
+
+    // Accelerometer status register
+    LSM303AGR_STATUS_REG_A = 0x27,
+
+    // Accelerometer output registers
+    LSM303AGR_OUT_X_L_A = 0x28,
+    LSM303AGR_OUT_X_H_A = 0x29,
+    LSM303AGR_OUT_Y_L_A = 0x2A,
+    LSM303AGR_OUT_Y_H_A = 0x2B,
+    LSM303AGR_OUT_Z_L_A = 0x2C,
+    LSM303AGR_OUT_Z_H_A = 0x2D,
+
+    // Accelerometer FIFO registers
+    LSM303AGR_FIFO_CTRL_REG_A = 0x2E,
+    LSM303AGR_FIFO_SRC_REG_A  = 0x2F,
+
     // Magnetometer hard-iron registers
     LSM303AGR_OFFSET_X_REG_L_M = 0x45,
     LSM303AGR_OFFSET_X_REG_H_M = 0x46,
@@ -134,13 +163,14 @@ typedef union {
     uint8_t byte;
 
     struct {
-        lsm303agr_enable_t INT_MAG_PIN : 1; // If 1, the INTERRUPT signal (INT bit inside INT_SOURCE_REG_M (64h)) is driven on INT_MAG_PIN
-        lsm303agr_enable_t I2C_DIS : 1;     // If 1, the I2C interface is inhibited. Only the SPI interface can be used.
-        lsm303agr_enable_t BDU : 1;         // If enabled, reading of incorrect data is avoided when the user reads asynchronously.
-        lsm303agr_enable_t BLE : 1;         // If 1, an inversion of the low and high parts of the data occurs.
-        uint8_t : 1;                        // This bit must be set to 0 for the correct operation of the device.
-        lsm303agr_enable_t Self_test : 1;   // If 1, the self-test is enabled.
         lsm303agr_enable_t INT_MAG : 1;     // If 1, the DRDY pin is configured as a digital output.
+        lsm303agr_enable_t Self_test : 1;   // If 1, the self-test is enabled.
+        uint8_t : 1;                        // This bit must be set to 0 for the correct operation of the device.
+        lsm303agr_enable_t BLE : 1;         // If 1, an inversion of the low and high parts of the data occurs.
+        lsm303agr_enable_t BDU : 1;         // If enabled, reading of incorrect data is avoided when the user reads asynchronously.
+        lsm303agr_enable_t I2C_DIS : 1;     // If 1, the I2C interface is inhibited. Only the SPI interface can be used.
+        lsm303agr_enable_t INT_MAG_PIN : 1; // If 1, the INTERRUPT signal (INT bit inside INT_SOURCE_REG_M (64h)) is driven on INT_MAG_PIN
+        uint8_t : 1;
     };
 } lsm303agr_config_reg_c_t;
 
@@ -174,4 +204,163 @@ typedef union {
     };
 } lsm303agr_int_source_t;
 
+typedef union {
+    uint8_t byte;
+
+    struct {
+        uint8_t Xda : 1;   // X-axis new data available.
+        uint8_t Yda : 1;   // Y-axis new data available.
+        uint8_t Zda : 1;   // Z-axis new data available.
+        uint8_t Zyxda : 1; // X-, Y- and Z-axis new data available.
+        uint8_t Xor : 1;   // X-axis data overrun, new data overwrote the previous data.
+        uint8_t Yor : 1;   // Y-axis data overrun.
+        uint8_t Zor : 1;   // Z-axis data overrun.
+        uint8_t Zyxor : 1; // X-, Y- and Z-axis data overrun.
+    };
+} lsm303agr_status_reg_t;
+
+// Magnetometer output sample, OUTX_L_REG_M..OUTZ_H_REG_M.
+typedef union {
+    uint8_t byte[6];
+
+    struct {
+        int16_t x; // X-axis output [LSB], 1.5 mgauss/LSB.
+        int16_t y; // Y-axis output [LSB], 1.5 mgauss/LSB.
+        int16_t z; // Z-axis output [LSB], 1.5 mgauss/LSB.
+    };
+
+    int16_t axis[3];
+} lsm303agr_mag_raw_t;
+
+// Magnetometer status and output sample, STATUS_REG_M..OUTZ_H_REG_M.
+typedef struct {
+    lsm303agr_status_reg_t status;
+    lsm303agr_mag_raw_t    raw;
+} lsm303agr_mag_sample_t;
+
+// Accelerometer output data rate configuration
+typedef enum {
+    LSM303AGR_XL_ODR_OFF         = 0b0000, // Power-down mode.
+    LSM303AGR_XL_ODR_1           = 0b0001, // 1 Hz
+    LSM303AGR_XL_ODR_10          = 0b0010, // 10 Hz
+    LSM303AGR_XL_ODR_25          = 0b0011, // 25 Hz
+    LSM303AGR_XL_ODR_50          = 0b0100, // 50 Hz
+    LSM303AGR_XL_ODR_100         = 0b0101, // 100 Hz
+    LSM303AGR_XL_ODR_200         = 0b0110, // 200 Hz
+    LSM303AGR_XL_ODR_400         = 0b0111, // 400 Hz
+    LSM303AGR_XL_ODR_1620_LP     = 0b1000, // 1.620 kHz, low-power mode only.
+    LSM303AGR_XL_ODR_1344_5376LP = 0b1001, // 1.344 kHz, 5.376 kHz in low-power mode.
+} lsm303agr_xl_odr_t;
+
+// Accelerometer operating mode (resolution)
+typedef enum {
+    LSM303AGR_XL_HR_12BIT = 0, // High-resolution mode.
+    LSM303AGR_XL_NM_10BIT = 1, // Normal mode.
+    LSM303AGR_XL_LP_8BIT  = 2, // Low-power mode.
+} lsm303agr_xl_op_md_t;
+
+// Accelerometer full scale selection
+typedef enum {
+    LSM303AGR_XL_FS_2G  = 0b00, // +/-2 g
+    LSM303AGR_XL_FS_4G  = 0b01, // +/-4 g
+    LSM303AGR_XL_FS_8G  = 0b10, // +/-8 g
+    LSM303AGR_XL_FS_16G = 0b11, // +/-16 g
+} lsm303agr_xl_fs_t;
+
+// Accelerometer FIFO mode selection
+typedef enum {
+    LSM303AGR_XL_FIFO_BYPASS         = 0b00, // FIFO is not used.
+    LSM303AGR_XL_FIFO_FIFO           = 0b01, // Collects data until full, then stops.
+    LSM303AGR_XL_FIFO_STREAM         = 0b10, // Collects data continuously, oldest data is overwritten.
+    LSM303AGR_XL_FIFO_STREAM_TO_FIFO = 0b11, // Stream mode until the trigger event, then FIFO mode.
+} lsm303agr_xl_fifo_md_t;
+
+typedef union {
+    uint8_t byte;
+
+    struct {
+        lsm303agr_enable_t Xen : 1;  // X-axis enable.
+        lsm303agr_enable_t Yen : 1;  // Y-axis enable.
+        lsm303agr_enable_t Zen : 1;  // Z-axis enable.
+        lsm303agr_enable_t LPen : 1; // Low-power mode enable.
+        lsm303agr_xl_odr_t ODR : 4;  // Data rate selection.
+    };
+} lsm303agr_ctrl_reg1_a_t;
+
+typedef union {
+    uint8_t byte;
+
+    struct {
+        uint8_t : 1;
+        lsm303agr_enable_t I1_OVERRUN : 1; // FIFO overrun interrupt on INT1.
+        lsm303agr_enable_t I1_WTM : 1;     // FIFO watermark interrupt on INT1.
+        lsm303agr_enable_t I1_DRDY2 : 1;   // DRDY2 interrupt on INT1.
+        lsm303agr_enable_t I1_DRDY1 : 1;   // DRDY1 interrupt on INT1.
+        lsm303agr_enable_t I1_AOI2 : 1;    // AOI2 interrupt on INT1.
+        lsm303agr_enable_t I1_AOI1 : 1;    // AOI1 interrupt on INT1.
+        lsm303agr_enable_t I1_CLICK : 1;   // Click interrupt on INT1.
+    };
+} lsm303agr_ctrl_reg3_a_t;
+
+typedef union {
+    uint8_t byte;
+
+    struct {
+        lsm303agr_enable_t SPI_ENABLE : 1; // 3-wire SPI interface enable.
+        uint8_t            ST : 2;         // Self-test enable.
+        lsm303agr_enable_t HR : 1;         // Operating mode selection.
+        lsm303agr_xl_fs_t  FS : 2;         // Full-scale selection.
+        lsm303agr_enable_t BLE : 1;        // Big/little endian data selection.
+        lsm303agr_enable_t BDU : 1;        // Block data update.
+    };
+} lsm303agr_ctrl_reg4_a_t;
+
+typedef union {
+    uint8_t byte;
+
+    struct {
+        lsm303agr_enable_t D4D_INT2 : 1; // 4D detection on INT2.
+        lsm303agr_enable_t LIR_INT2 : 1; // Latch interrupt request on INT2.
+        lsm303agr_enable_t D4D_INT1 : 1; // 4D detection on INT1.
+        lsm303agr_enable_t LIR_INT1 : 1; // Latch interrupt request on INT1.
+        uint8_t : 2;
+        lsm303agr_enable_t FIFO_EN : 1; // FIFO enable.
+        lsm303agr_enable_t BOOT : 1;    // Reboot accelerometer memory content.
+    };
+} lsm303agr_ctrl_reg5_a_t;
+
+typedef union {
+    uint8_t byte;
+
+    struct {
+        uint8_t                FTH : 5; // FIFO watermark level.
+        uint8_t                TR : 1;  // Trigger selection, 0: INT1, 1: INT2.
+        lsm303agr_xl_fifo_md_t FM : 2;  // FIFO mode selection.
+    };
+} lsm303agr_fifo_ctrl_reg_a_t;
+
+typedef union {
+    uint8_t byte;
+
+    struct {
+        uint8_t FSS : 5;       // Number of unread samples stored in FIFO.
+        uint8_t EMPTY : 1;     // FIFO is empty.
+        uint8_t OVRN_FIFO : 1; // FIFO is full, the 32 samples are unread.
+        uint8_t WTM : 1;       // FIFO content exceeds the watermark level.
+    };
+} lsm303agr_fifo_src_reg_a_t;
+
+// Accelerometer output sample, OUT_X_L_A..OUT_Z_H_A, left justified.
+typedef union {
+    uint8_t byte[6];
+
+    struct {
+        int16_t x; // X-axis output, left justified to the selected resolution.
+        int16_t y; // Y-axis output, left justified to the selected resolution.
+        int16_t z; // Z-axis output, left justified to the selected resolution.
+    };
+
+    int16_t axis[3];
+} lsm303agr_xl_raw_t;
+
 #pragma pack()
\ No newline at end of file
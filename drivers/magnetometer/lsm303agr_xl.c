@@ -0,0 +1,323 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "lsm303agr_xl.h"
+
+#include "app_util.h"
+#include "lsm303agr.h"
+#include "nrf_delay.h"
+
+#define NRF_LOG_MODULE_NAME LSM303AGR_XL
+#define NRF_LOG_LEVEL 3 // LOG_LEVEL
+#include "nrfx_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define I2C_ADDR LSM303AGR_I2C_ADD_XL // Accelerometer I2C address.
+#define BOOT_TIME 5
+#define AUTO_INCREMENT 0x80 // Sub-address MSB enables address auto-increment.
+
+bool lsm303agr_xl_init(void)
+{
+    const lsm303agr_bus_t *p_bus = lsm303agr_bus_get();
+
+    // Bus is selected by lsm303agr_init().
+    if (p_bus == NULL) {
+        NRFX_LOG_WARNING("%s No bus selected.", __func__);
+        return false;
+    }
+
+    // Wait for device boot time.
+    nrf_delay_ms(BOOT_TIME);
+
+    // 3-wire SPI must be enabled before the first read, the register is written blindly.
+    if (p_bus->type == LSM303AGR_BUS_SPIM) {
+        lsm303agr_ctrl_reg4_a_t ctrl = {.SPI_ENABLE = LSM303AGR_ENABLE};
+
+        if (!lsm303agr_write_register(I2C_ADDR, LSM303AGR_CTRL_REG4_A, ctrl.byte)) {
+            return false;
+        }
+    }
+
+    // Read who am i register (in order to check device).
+    uint8_t id = lsm303agr_xl_get_device_id();
+    if (id != LSM303AGR_ID_XL) {
+        NRFX_LOG_WARNING("%s LSM303AGR is not found expceted id: %x, received id: %d.", __func__, LSM303AGR_ID_XL, id);
+
+        // LSM303AGR is not found.
+        return false;
+    }
+
+    return true;
+}
+
+uint8_t lsm303agr_xl_get_device_id(void) { return lsm303agr_read_register(I2C_ADDR, LSM303AGR_WHO_AM_I_A); }
+
+bool lsm303agr_xl_set_reboot(lsm303agr_enable_t value)
+{
+    lsm303agr_ctrl_reg5_a_t ctrl;
+
+    ctrl.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG5_A);
+    ctrl.BOOT = value;
+
+    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CTRL_REG5_A, ctrl.byte);
+}
+
+lsm303agr_enable_t lsm303agr_xl_get_reboot(void)
+{
+    lsm303agr_ctrl_reg5_a_t ctrl;
+
+    ctrl.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG5_A);
+
+    return ctrl.BOOT;
+}
+
+bool lsm303agr_xl_set_odr(lsm303agr_xl_odr_t value)
+{
+    lsm303agr_ctrl_reg1_a_t ctrl;
+
+    ctrl.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG1_A);
+    ctrl.ODR  = value;
+
+    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CTRL_REG1_A, ctrl.byte);
+}
+
+lsm303agr_xl_odr_t lsm303agr_xl_get_odr(void)
+{
+    lsm303agr_ctrl_reg1_a_t ctrl;
+
+    ctrl.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG1_A);
+
+    return ctrl.ODR;
+}
+
+bool lsm303agr_xl_set_op_mode(lsm303agr_xl_op_md_t value)
+{
+    lsm303agr_ctrl_reg1_a_t ctrl1;
+    lsm303agr_ctrl_reg4_a_t ctrl4;
+
+    // LPen = 1 and HR = 1 is not allowed, clear the current one first.
+    ctrl1.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG1_A);
+    ctrl4.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG4_A);
+
+    ctrl1.LPen = (value == LSM303AGR_XL_LP_8BIT) ? LSM303AGR_ENABLE : LSM303AGR_DISABLE;
+    ctrl4.HR   = (value == LSM303AGR_XL_HR_12BIT) ? LSM303AGR_ENABLE : LSM303AGR_DISABLE;
+
+    if (ctrl1.LPen == LSM303AGR_DISABLE) {
+        return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CTRL_REG1_A, ctrl1.byte) &&
+               lsm303agr_write_register(I2C_ADDR, LSM303AGR_CTRL_REG4_A, ctrl4.byte);
+    }
+
+    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CTRL_REG4_A, ctrl4.byte) &&
+           lsm303agr_write_register(I2C_ADDR, LSM303AGR_CTRL_REG1_A, ctrl1.byte);
+}
+
+lsm303agr_xl_op_md_t lsm303agr_xl_get_op_mode(void)
+{
+    lsm303agr_ctrl_reg1_a_t ctrl1;
+    lsm303agr_ctrl_reg4_a_t ctrl4;
+
+    ctrl1.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG1_A);
+    ctrl4.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG4_A);
+
+    if (ctrl1.LPen == LSM303AGR_ENABLE) {
+        return LSM303AGR_XL_LP_8BIT;
+    }
+
+    return (ctrl4.HR == LSM303AGR_ENABLE) ? LSM303AGR_XL_HR_12BIT : LSM303AGR_XL_NM_10BIT;
+}
+
+bool lsm303agr_xl_set_full_scale(lsm303agr_xl_fs_t value)
+{
+    lsm303agr_ctrl_reg4_a_t ctrl;
+
+    ctrl.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG4_A);
+    ctrl.FS   = value;
+
+    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CTRL_REG4_A, ctrl.byte);
+}
+
+lsm303agr_xl_fs_t lsm303agr_xl_get_full_scale(void)
+{
+    lsm303agr_ctrl_reg4_a_t ctrl;
+
+    ctrl.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG4_A);
+
+    return ctrl.FS;
+}
+
+bool lsm303agr_xl_set_bdu(lsm303agr_enable_t value)
+{
+    lsm303agr_ctrl_reg4_a_t ctrl;
+
+    ctrl.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG4_A);
+    ctrl.BDU  = value;
+
+    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CTRL_REG4_A, ctrl.byte);
+}
+
+lsm303agr_enable_t lsm303agr_xl_get_bdu(void)
+{
+    lsm303agr_ctrl_reg4_a_t ctrl;
+
+    ctrl.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG4_A);
+
+    return ctrl.BDU;
+}
+
+bool lsm303agr_xl_set_ble(lsm303agr_enable_t value)
+{
+    lsm303agr_ctrl_reg4_a_t ctrl;
+
+    ctrl.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG4_A);
+    ctrl.BLE  = value;
+
+    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CTRL_REG4_A, ctrl.byte);
+}
+
+lsm303agr_enable_t lsm303agr_xl_get_ble(void)
+{
+    lsm303agr_ctrl_reg4_a_t ctrl;
+
+    ctrl.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG4_A);
+
+    return ctrl.BLE;
+}
+
+bool lsm303agr_xl_set_fifo_enable(lsm303agr_enable_t value)
+{
+    lsm303agr_ctrl_reg5_a_t ctrl;
+
+    ctrl.byte    = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG5_A);
+    ctrl.FIFO_EN = value;
+
+    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CTRL_REG5_A, ctrl.byte);
+}
+
+lsm303agr_enable_t lsm303agr_xl_get_fifo_enable(void)
+{
+    lsm303agr_ctrl_reg5_a_t ctrl;
+
+    ctrl.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG5_A);
+
+    return ctrl.FIFO_EN;
+}
+
+bool lsm303agr_xl_set_fifo_mode(lsm303agr_xl_fifo_md_t value)
+{
+    lsm303agr_fifo_ctrl_reg_a_t ctrl;
+
+    ctrl.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_FIFO_CTRL_REG_A);
+    ctrl.FM   = value;
+
+    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_FIFO_CTRL_REG_A, ctrl.byte);
+}
+
+lsm303agr_xl_fifo_md_t lsm303agr_xl_get_fifo_mode(void)
+{
+    lsm303agr_fifo_ctrl_reg_a_t ctrl;
+
+    ctrl.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_FIFO_CTRL_REG_A);
+
+    return ctrl.FM;
+}
+
+bool lsm303agr_xl_set_fifo_watermark(uint8_t value)
+{
+    lsm303agr_fifo_ctrl_reg_a_t ctrl;
+
+    ctrl.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_FIFO_CTRL_REG_A);
+    ctrl.FTH  = value;
+
+    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_FIFO_CTRL_REG_A, ctrl.byte);
+}
+
+uint8_t lsm303agr_xl_get_fifo_watermark(void)
+{
+    lsm303agr_fifo_ctrl_reg_a_t ctrl;
+
+    ctrl.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_FIFO_CTRL_REG_A);
+
+    return ctrl.FTH;
+}
+
+bool lsm303agr_xl_set_int1_fifo_wtm(lsm303agr_enable_t value)
+{
+    lsm303agr_ctrl_reg3_a_t ctrl;
+
+    ctrl.byte   = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG3_A);
+    ctrl.I1_WTM = value;
+
+    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CTRL_REG3_A, ctrl.byte);
+}
+
+lsm303agr_enable_t lsm303agr_xl_get_int1_fifo_wtm(void)
+{
+    lsm303agr_ctrl_reg3_a_t ctrl;
+
+    ctrl.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG3_A);
+
+    return ctrl.I1_WTM;
+}
+
+bool lsm303agr_xl_set_int1_fifo_overrun(lsm303agr_enable_t value)
+{
+    lsm303agr_ctrl_reg3_a_t ctrl;
+
+    ctrl.byte       = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG3_A);
+    ctrl.I1_OVERRUN = value;
+
+    return lsm303agr_write_register(I2C_ADDR, LSM303AGR_CTRL_REG3_A, ctrl.byte);
+}
+
+lsm303agr_enable_t lsm303agr_xl_get_int1_fifo_overrun(void)
+{
+    lsm303agr_ctrl_reg3_a_t ctrl;
+
+    ctrl.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_CTRL_REG3_A);
+
+    return ctrl.I1_OVERRUN;
+}
+
+lsm303agr_fifo_src_reg_a_t lsm303agr_xl_get_fifo_src(void)
+{
+    lsm303agr_fifo_src_reg_a_t ret;
+
+    ret.byte = lsm303agr_read_register(I2C_ADDR, LSM303AGR_FIFO_SRC_REG_A);
+
+    return ret;
+}
+
+bool lsm303agr_xl_read_raw(lsm303agr_xl_raw_t *p_raw)
+{
+    return lsm303agr_read_continuous(I2C_ADDR, LSM303AGR_OUT_X_L_A | AUTO_INCREMENT, p_raw->byte, sizeof(p_raw->byte));
+}
+
+bool lsm303agr_xl_read_fifo(lsm303agr_xl_raw_t *p_samples, uint8_t max, uint8_t *p_count)
+{
+    lsm303agr_fifo_src_reg_a_t src;
+
+    *p_count = 0;
+
+    if (!lsm303agr_read_continuous(I2C_ADDR, LSM303AGR_FIFO_SRC_REG_A, &src.byte, sizeof(src.byte))) {
+        return false;
+    }
+
+    // FSS holds up to 31 unread samples, overrun means the FIFO is full.
+    uint8_t count = src.OVRN_FIFO ? LSM303AGR_XL_FIFO_DEPTH : src.FSS;
+    count         = MIN(count, max);
+    if (count == 0) {
+        return true;
+    }
+
+    // With FIFO enabled the address rolls back from OUT_Z_H_A to OUT_X_L_A, the whole FIFO is one transfer.
+    if (!lsm303agr_read_continuous(I2C_ADDR, LSM303AGR_OUT_X_L_A | AUTO_INCREMENT, p_samples->byte, count * sizeof(p_samples->byte))) {
+        return false;
+    }
+
+    *p_count = count;
+
+    return true;
+}
@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include "lsm303agr_types.h"
+
+/** Accelerometer FIFO depth in samples. */
+#define LSM303AGR_XL_FIFO_DEPTH 32
+
+/** Initializing LSM303AGR accelerometer device.*/
+bool lsm303agr_xl_init(void);
+
+/** Read device who am i register.*/
+uint8_t lsm303agr_xl_get_device_id(void);
+
+/** Reboots accelerometer memory content. */
+bool               lsm303agr_xl_set_reboot(lsm303agr_enable_t value);
+lsm303agr_enable_t lsm303agr_xl_get_reboot(void);
+
+/** Output data rate configuration, LSM303AGR_XL_ODR_OFF is power-down mode. */
+bool               lsm303agr_xl_set_odr(lsm303agr_xl_odr_t value);
+lsm303agr_xl_odr_t lsm303agr_xl_get_odr(void);
+
+/** Operating mode (8, 10 or 12 bit resolution). */
+bool                 lsm303agr_xl_set_op_mode(lsm303agr_xl_op_md_t value);
+lsm303agr_xl_op_md_t lsm303agr_xl_get_op_mode(void);
+
+/** Full-scale selection. */
+bool              lsm303agr_xl_set_full_scale(lsm303agr_xl_fs_t value);
+lsm303agr_xl_fs_t lsm303agr_xl_get_full_scale(void);
+
+/** Block data update. */
+bool               lsm303agr_xl_set_bdu(lsm303agr_enable_t value);
+lsm303agr_enable_t lsm303agr_xl_get_bdu(void);
+
+/** Big/little endian data selection. */
+bool               lsm303agr_xl_set_ble(lsm303agr_enable_t value);
+lsm303agr_enable_t lsm303agr_xl_get_ble(void);
+
+/** FIFO enable. */
+bool               lsm303agr_xl_set_fifo_enable(lsm303agr_enable_t value);
+lsm303agr_enable_t lsm303agr_xl_get_fifo_enable(void);
+
+/** FIFO mode selection. */
+bool                   lsm303agr_xl_set_fifo_mode(lsm303agr_xl_fifo_md_t value);
+lsm303agr_xl_fifo_md_t lsm303agr_xl_get_fifo_mode(void);
+
+/** FIFO watermark level, 0..31 samples. */
+bool    lsm303agr_xl_set_fifo_watermark(uint8_t value);
+uint8_t lsm303agr_xl_get_fifo_watermark(void);
+
+/** FIFO watermark interrupt on INT1 pin. */
+bool               lsm303agr_xl_set_int1_fifo_wtm(lsm303agr_enable_t value);
+lsm303agr_enable_t lsm303agr_xl_get_int1_fifo_wtm(void);
+
+/** FIFO overrun interrupt on INT1 pin. */
+bool               lsm303agr_xl_set_int1_fifo_overrun(lsm303agr_enable_t value);
+lsm303agr_enable_t lsm303agr_xl_get_int1_fifo_overrun(void);
+
+/** FIFO source register, stored samples, watermark and overrun flags. */
+lsm303agr_fifo_src_reg_a_t lsm303agr_xl_get_fifo_src(void);
+
+/** Read X, Y and Z output in one 6 bytes burst. */
+bool lsm303agr_xl_read_raw(lsm303agr_xl_raw_t *p_raw);
+
+/**@brief       Drain the FIFO in one burst transfer.
+ *
+ * @param[out]  p_samples -   Samples buffer, located in RAM.
+ * @param[in]   max       -   Size of the samples buffer, up to LSM303AGR_XL_FIFO_DEPTH.
+ * @param[out]  p_count   -   Number of samples read.
+ *
+ * @retval  True if read completed successfully.
+ */
+bool lsm303agr_xl_read_fifo(lsm303agr_xl_raw_t *p_samples, uint8_t max, uint8_t *p_count);
@@ -6,11 +6,20 @@
 
 #include "magnetometer.h"
 
+#include "app_scheduler.h"
 #include "app_timer.h"
 #include "app_util.h"
 #include "config.h"
+#include "lsm303agr.h"
 #include "lsm303agr_mag.h"
+#include "lsm303agr_mag_stream.h"
+#include "magnetometer_baseline.h"
+#include "magnetometer_ellipsoid.h"
+#include "magnetometer_odr.h"
 #include "nrf_delay.h"
+#include "profile/profile.h"
+
+#include <string.h>
 
 #define NRF_LOG_MODULE_NAME MAGNETOMETER
 #define NRF_LOG_LEVEL 3 // LOG_LEVEL
@@ -18,32 +27,479 @@
 NRF_LOG_MODULE_REGISTER();
 
 APP_TIMER_DEF(m_magnetometer_timer);
+APP_TIMER_DEF(m_sample_timer);
+APP_TIMER_DEF(m_poll_timer);
+APP_TIMER_DEF(m_release_timer);
+APP_TIMER_DEF(m_calibration_timer);
+APP_TIMER_DEF(m_measure_timer);
+APP_TIMER_DEF(m_measure_periodic_timer);
+APP_TIMER_DEF(m_settings_timer);
 
-#define MAGNETOMETER_DEBOUNCE_MS APP_TIMER_TICKS(200)
-#define MAGNETOMETER_THRESHOLD_VALUE 0x300 // ~ 1.5*768 = 1152 [mgauss]
+#define MAGNETOMETER_DEBOUNCE_MS APP_TIMER_TICKS(20) // Pin glitch filter, the comparator hysteresis prevents chatter.
+#define MAGNETOMETER_LATENCY_BUDGET_MS 300          // Default worst-case confirmation latency, 3 periods at 10 Hz.
+#define MAGNETOMETER_CONFIRM_OVERHEAD 2             // Sample periods of the latency spent outside the confirmation.
+#define MAGNETOMETER_CALIBRATION_SPAN 200          // Minimal per-axis output span [LSB] of a calibration rotation.
+#define MAGNETOMETER_MEASURE_TIMEOUT_MS 50         // Upper bound of a single measurement until DRDY.
+#define MAGNETOMETER_RELEASE_SAMPLES 2              // Sample periods without a latched interrupt to release the magnet.
+#define MAGNETOMETER_THRESHOLD_ASSERT 0x300        // ~ 1.5*768 = 1152 [mgauss]
+#define MAGNETOMETER_THRESHOLD_RELEASE 0x200       // ~ 1.5*512 = 768 [mgauss]
 #define MAGNETOMETER_INT_IEA LSM303AGR_INT_HIGH
+#define MAGNETOMETER_PROFILE_ODR LSM303AGR_ODR_10 // Output data rate without the adaptive rate.
+#define MAGNETOMETER_PROFILE_LP LSM303AGR_LP_HIGH // Low-power mode without the adaptive rate.
+#define MAGNETOMETER_POLL_IDLE_MS 1000            // Output poll period at 10 Hz, see poll_period_ms().
+
+typedef struct {
+    magnetometer_handler_t handler; // Callback function to notify on events.
+    uint32_t               filter;  // Event types delivered to the handler.
+} subscriber_t;
+
+STATIC_ASSERT((MAGNETOMETER_EVT_QUEUE_SIZE & (MAGNETOMETER_EVT_QUEUE_SIZE - 1)) == 0);
+STATIC_ASSERT(MAGNETOMETER_EVT_QUEUE_SIZE <= 128);
+
+// Single producer (interrupt context, GPIOTE and app_timer share one priority), single consumer (main loop).
+static magnetometer_evt_t m_evt_queue[MAGNETOMETER_EVT_QUEUE_SIZE];
+static volatile uint8_t   m_evt_write     = 0;     // Free running, written by the producer only.
+static volatile uint8_t   m_evt_read      = 0;     // Free running, written by the consumer only.
+static volatile bool      m_evt_scheduled = false; // Dispatch is pending in the scheduler queue.
+static uint32_t           m_evt_dropped   = 0;     // Events lost on a full queue.
 
-static magnetometer_handler_t m_event_handler = NULL; // Callback function to notify on events.
-static magnetometer_event_t   m_last_event    = MAGNETOMETER_EVENT_NOTHING;
+static subscriber_t         m_subscribers[MAGNETOMETER_MAX_SUBSCRIBERS];
+static uint8_t              m_subscriber_count = 0;
+static magnetometer_event_t m_last_event       = MAGNETOMETER_EVENT_NOTHING;
+static uint8_t              m_last_axes        = 0; // Axis flags of the last detection.
 
 static bool m_lsm303_flag = false; // Flag to indicate lsm303 sensor is detected.
 
+static int16_t m_threshold_assert  = MAGNETOMETER_THRESHOLD_ASSERT;  // Field to detect the magnet [LSB].
+static int16_t m_threshold_release = MAGNETOMETER_THRESHOLD_RELEASE; // Field to release the magnet [LSB].
+
+static magnetometer_debounce_t m_debounce_mode     = MAGNETOMETER_DEBOUNCE_TIME;
+static uint32_t                m_latency_budget_ms = MAGNETOMETER_LATENCY_BUDGET_MS;
+static uint32_t                m_confirm_samples   = 1; // Consecutive samples confirming a new state.
+static uint32_t                m_confirm_count     = 0; // Consecutive samples seen in the new state.
+
+static magnetometer_int_mode_t m_int_mode = MAGNETOMETER_INT_PULSED;
+
+static bool               m_adaptive_odr = true; // Output data rate follows the distance of the field from the threshold.
+static magnetometer_odr_t m_odr_policy;
+static lsm303agr_odr_t    m_profile_odr = MAGNETOMETER_PROFILE_ODR; // Rate of the profile, m_config.odr follows the policy.
+static lsm303agr_lp_t     m_profile_lp  = MAGNETOMETER_PROFILE_LP;  // Low-power mode of the profile.
+
+static bool                    m_baseline_tracking = true; // Ambient field is tracked into the hard-iron offset.
+static magnetometer_baseline_t m_baseline;
+
+static volatile bool       m_calibrating = false;
+static volatile bool       m_cal_solving = false; // Window closed, the fit waits for the main loop.
+static int16_t             m_cal_min[3];  // Per-axis output minimum of the calibration window.
+static int16_t             m_cal_max[3];  // Per-axis output maximum of the calibration window.
+static lsm303agr_mag_raw_t m_cal_restore; // Offset restored if the calibration fails.
+
+static magnetometer_ellipsoid_t            m_cal_fit;    // Ellipsoid fit of the calibration window.
+static magnetometer_ellipsoid_correction_t m_correction; // Soft-iron correction of reported samples.
+
+static lsm303agr_mag_stream_handler_t m_stream_handler;                                  // Handler of the stream.
+static lsm303agr_mag_raw_t            m_stream_samples[LSM303AGR_MAG_STREAM_DEPTH / 2]; // Corrected half ring.
+
+static volatile bool       m_measuring        = false; // Single measurement waits for DRDY.
+static volatile bool       m_measure_ok       = false; // Sample of the last single measurement was read.
+static bool                m_measure_periodic = false; // Single measurements are triggered by the periodic timer.
+static lsm303agr_mag_raw_t m_measure_sample;           // Sample of the last single measurement.
+
+static lsm303agr_mag_config_t m_config = {
+    .md             = LSM303AGR_MODE_IDLE,
+    .odr            = MAGNETOMETER_PROFILE_ODR,
+    .lp             = MAGNETOMETER_PROFILE_LP,
+    .comp_temp      = LSM303AGR_ENABLE, // For proper operation, this bit must be set to 1.
+    .lpf            = LSM303AGR_DISABLE,
+    .set_rst        = LSM303AGR_SET_SENS_ODR_DIV_63,
+    .int_ctrl       = {.IEN  = LSM303AGR_ENABLE,    // Enables interrupt.
+                       .ZIEN = LSM303AGR_ENABLE,    // Enables interrupt for z-axis.
+                       .YIEN = LSM303AGR_ENABLE,    // Enables interrupt for y-axis.
+                       .XIEN = LSM303AGR_ENABLE,    // Enables interrupt for x-axis.
+                       .IEL  = LSM303AGR_INT_PULSE, // Pulsed interrupt.
+                       .IEA  = MAGNETOMETER_INT_IEA},
+    .int_threshold  = MAGNETOMETER_THRESHOLD_ASSERT,
+    .int_on_dataoff = LSM303AGR_ENABLE, // Comparator checks the offset-corrected output.
+    .int_on_pin     = LSM303AGR_ENABLE, // Enable interrupt on MAG_PIN.
+    .drdy_on_pin    = LSM303AGR_ENABLE, // Set MAG_PIN as an output.
+    .bdu            = LSM303AGR_ENABLE, // Output bytes of a sample are read together.
+    .ble            = LSM303AGR_MAG_BLE_NATIVE,
+    .i2c_dis        = LSM303AGR_DISABLE, // Set by magnetometer_reset() on the SPI bus.
+};
+
 static void magnetometer_timer_handler(void *p_context);
+static void magnetometer_sample_timer_handler(void *p_context);
+static void magnetometer_poll_timer_handler(void *p_context);
+static void magnetometer_release_timer_handler(void *p_context);
+static void magnetometer_calibration_timer_handler(void *p_context);
+static void magnetometer_measure_timer_handler(void *p_context);
+static void magnetometer_measure_periodic_timer_handler(void *p_context);
+static void magnetometer_settings_timer_handler(void *p_context);
+
+static magnetometer_event_t get_current_event(lsm303agr_int_source_t source)
+{
+    // INT is set while any enabled axis exceeds the threshold, regardless of the pin polarity (IEA).
+    return source.INT ? MAGNETOMETER_EVENT_MAGNET_DETECTED : MAGNETOMETER_EVENT_MAGNET_NOT_DETECTED;
+}
+
+/**@brief       Program the comparator threshold of the opposite transition.
+ *
+ * @param[in]   event     -   Current magnet state.
+ */
+static void threshold_update(magnetometer_event_t event)
+{
+    // A detected magnet is held until the field drops below the release threshold.
+    m_config.int_threshold = (event == MAGNETOMETER_EVENT_MAGNET_DETECTED) ? m_threshold_release : m_threshold_assert;
+
+    if (!lsm303agr_mag_set_int_threshold(m_config.int_threshold)) {
+        NRFX_LOG_WARNING("%s Threshold write failed.", __func__);
+    }
+}
+
+/**@brief       Deliver queued events to subscribers, scheduler handler running in the main loop.
+ *
+ */
+static void event_dispatch(void *p_event_data, uint16_t event_size)
+{
+    // Cleared first, an event queued from now on schedules another dispatch.
+    m_evt_scheduled = false;
+
+    while (m_evt_read != m_evt_write) {
+        __DMB();
+
+        magnetometer_evt_t *p_evt = &m_evt_queue[m_evt_read % MAGNETOMETER_EVT_QUEUE_SIZE];
+
+        for (uint8_t i = 0; i < m_subscriber_count; i++) {
+            if (m_subscribers[i].filter & MAGNETOMETER_EVT_MASK(p_evt->type)) {
+                m_subscribers[i].handler(p_evt);
+            }
+        }
+
+        // Release the slot after the handlers are done with it.
+        __DMB();
+        m_evt_read++;
+    }
+}
+
+/**@brief       Queue an event for the main loop, called from the producer interrupt priority.
+ *
+ * @param[in]   type      -   Event type.
+ * @param[in]   p_field   -   Field sample, may be NULL.
+ * @param[in]   axes      -   MAGNETOMETER_AXIS_* flags.
+ */
+static void event_emit(magnetometer_event_t type, const lsm303agr_mag_raw_t *p_field, uint8_t axes)
+{
+    if ((uint8_t)(m_evt_write - m_evt_read) == MAGNETOMETER_EVT_QUEUE_SIZE) {
+        m_evt_dropped++;
+        NRFX_LOG_WARNING("%s Event queue is full, dropped: %d.", __func__, m_evt_dropped);
+        return;
+    }
+
+    magnetometer_evt_t *p_evt = &m_evt_queue[m_evt_write % MAGNETOMETER_EVT_QUEUE_SIZE];
+
+    p_evt->type      = type;
+    p_evt->timestamp = app_timer_cnt_get();
+    p_evt->axes      = axes;
+    if (p_field != NULL) {
+        p_evt->field = *p_field;
+    } else {
+        memset(&p_evt->field, 0, sizeof(p_evt->field));
+    }
+
+    // Publish the slot after it is written.
+    __DMB();
+    m_evt_write++;
+
+    if (!m_evt_scheduled) {
+        m_evt_scheduled = (app_sched_event_put(NULL, 0, event_dispatch) == NRF_SUCCESS);
+    }
+}
+
+/**@brief       Report a new magnet state.
+ *
+ * @param[in]   event     -   Confirmed magnet state.
+ * @param[in]   source    -   INT_SOURCE_REG_M of the confirming sample.
+ */
+static void state_report(magnetometer_event_t event, lsm303agr_int_source_t source)
+{
+    if (m_last_event == event) {
+        return;
+    }
+
+    // Set last event to current event.
+    m_last_event = event;
+
+    // Comparator detects the opposite transition from now on.
+    threshold_update(event);
+
+    // Axis and side come from the same INT_SOURCE read, a release reports the axes it releases.
+    if (event == MAGNETOMETER_EVENT_MAGNET_DETECTED) {
+        m_last_axes = source.byte & MAGNETOMETER_AXIS_MASK;
+    }
+
+    // Report new magnet state.
+    event_emit(event, NULL, m_last_axes);
+}
+
+/**@brief       Consecutive samples confirming a detection within the latency budget at an output data rate.
+ *
+ * @note        The worst-case latency is K + MAGNETOMETER_CONFIRM_OVERHEAD sample periods: the field changes just after
+ *              a sample, and the confirming reads run up to one period after the samples they read.
+ *
+ * @param[in]   odr       -   Output data rate.
+ *
+ * @retval  K, zero if the budget is below the overhead plus one sample.
+ */
+static uint32_t confirm_samples_at(lsm303agr_odr_t odr)
+{
+    uint32_t periods = (m_latency_budget_ms * magnetometer_odr_hz(odr)) / 1000;
+
+    return (periods > MAGNETOMETER_CONFIRM_OVERHEAD) ? (periods - MAGNETOMETER_CONFIRM_OVERHEAD) : 0;
+}
+
+/** Consecutive samples confirming a detection at the current output data rate. */
+static uint32_t confirm_samples(void) { return MAX(1, confirm_samples_at(m_config.odr)); }
+
+/**@brief       Output poll period of the rate policy and the ambient field estimator.
+ *
+ * @note        DRDY shares the pin with INT and can not pace the reads. At 10 Hz the comparator catches a magnet on
+ *              its own, one read per second is enough to step the rate up and to follow the ambient field. Closer to
+ *              the threshold, and during a calibration, every sample is read.
+ *
+ * @retval  Poll period [ms].
+ */
+static uint32_t poll_period_ms(void)
+{
+    if (!m_calibrating && (m_config.odr == LSM303AGR_ODR_10)) {
+        return MAGNETOMETER_POLL_IDLE_MS;
+    }
+
+    return 1000 / magnetometer_odr_hz(m_config.odr);
+}
+
+/** Restart the output poll at the current period, stopped if nothing needs the output. */
+static void poll_restart(void)
+{
+    app_timer_stop(m_poll_timer);
+
+    if (m_calibrating || m_adaptive_odr || m_baseline_tracking) {
+        app_timer_start(m_poll_timer, APP_TIMER_TICKS(poll_period_ms()), NULL);
+    }
+}
+
+/**@brief       Release window of the latched mode, follows the ODR.
+ *
+ * @param[in]   samples   -   Sample periods of the window.
+ *
+ * @retval  Window in app_timer ticks.
+ */
+static uint32_t release_window_ticks(uint32_t samples)
+{
+    return APP_TIMER_TICKS((samples * 1000) / magnetometer_odr_hz(m_config.odr)) + 1;
+}
+
+/**@brief       Switch the interrupt between latched and pulsed in the latched mode.
+ *
+ * @param[in]   iel       -   Interrupt latch setting.
+ *
+ * @retval  True if the setting was written.
+ */
+static bool latched_iel_set(lsm303agr_int_signal_t iel)
+{
+    lsm303agr_int_cntl_t int_ctrl = m_config.int_ctrl;
+
+    int_ctrl.IEL = iel;
+
+    if (!lsm303agr_mag_set_int_ctrl(int_ctrl)) {
+        NRFX_LOG_WARNING("%s Interrupt control write failed.", __func__);
+        return false;
+    }
+
+    m_config.int_ctrl = int_ctrl;
+    return true;
+}
+
+/** A latched mode detection is held on the pulsed interrupt. */
+static bool latched_holding(void)
+{
+    return (m_int_mode == MAGNETOMETER_INT_LATCHED) && (m_config.int_ctrl.IEL == LSM303AGR_INT_PULSE);
+}
+
+/**@brief       Count a latched sample above the threshold.
+ *
+ * @param[in]   source    -   INT_SOURCE_REG_M of the sample.
+ */
+static void latched_sample(lsm303agr_int_source_t source)
+{
+    // The magnet is released unless the interrupt latches again within the window.
+    app_timer_stop(m_release_timer);
+    app_timer_start(m_release_timer, release_window_ticks(MAGNETOMETER_RELEASE_SAMPLES), NULL);
+
+    if (m_last_event != MAGNETOMETER_EVENT_MAGNET_DETECTED) {
+        if (++m_confirm_count < confirm_samples()) {
+            return;
+        }
+
+        state_report(MAGNETOMETER_EVENT_MAGNET_DETECTED, source);
+    }
+
+    // Hold the detection on a pulsed INT, the pin stays active and the magnet costs no further interrupt. A failed
+    // write keeps the latch and is retried on the next latched sample.
+    latched_iel_set(LSM303AGR_INT_PULSE);
+}
+
+/**@brief       Service a latched interrupt, the pin event stays enabled so no edge is lost.
+ *
+ * @param[in]   pin       -   Interrupt pin.
+ */
+static void latched_int_handle(uint32_t pin)
+{
+    lsm303agr_int_source_t source;
+
+    // Falling edge caused by the INT_SOURCE read below.
+    if (nrf_gpio_pin_read(pin) != MAGNETOMETER_INT_IEA) {
+        return;
+    }
+
+    // Reading clears the latch, the next sample above the threshold latches again.
+    if (!lsm303agr_mag_read_int_source(&source)) {
+        // Latch is still set and produces no edge, retry from the release timer.
+        app_timer_stop(m_release_timer);
+        app_timer_start(m_release_timer, APP_TIMER_TICKS(1000 / magnetometer_odr_hz(m_config.odr)) + 1, NULL);
+        return;
+    }
+
+    if (source.INT) {
+        latched_sample(source);
+    }
+}
+
+/** Release a held detection, back to one latched interrupt per sample above the assert threshold. */
+static void latched_release(void)
+{
+    lsm303agr_int_source_t source = {0};
+
+    m_confirm_count = 0;
+    state_report(MAGNETOMETER_EVENT_MAGNET_NOT_DETECTED, source);
+
+    if (!latched_iel_set(LSM303AGR_INT_LATCH)) {
+        // Retry from the release timer.
+        app_timer_start(m_release_timer, release_window_ticks(1), NULL);
+        return;
+    }
+
+    // INT raised before the switch produces no edge, service it now.
+    if (nrf_gpio_pin_read(MAG_INT_PIN) == MAGNETOMETER_INT_IEA) {
+        latched_int_handle(MAG_INT_PIN);
+    }
+}
 
-static magnetometer_event_t get_current_event(uint32_t pin)
+/**@brief       Service an edge of a held detection, INT follows the release threshold on every sample.
+ *
+ * @param[in]   pin       -   Interrupt pin.
+ */
+static void latched_hold_edge(uint32_t pin)
 {
-    bool state = (nrf_gpio_pin_read(pin) == MAGNETOMETER_INT_IEA);
+    app_timer_stop(m_release_timer);
+
+    // Released once INT stays inactive for the window, the sample clearing INT is the first one of it. A pending
+    // switch back to the latch is retried.
+    if ((m_last_event != MAGNETOMETER_EVENT_MAGNET_DETECTED) || (nrf_gpio_pin_read(pin) != MAGNETOMETER_INT_IEA)) {
+        app_timer_start(m_release_timer, release_window_ticks(MAGNETOMETER_RELEASE_SAMPLES - 1), NULL);
+    }
+}
+
+/**@brief       Stop sample counting and wait for the next edge.
+ *
+ * @param[in]   pin       -   Interrupt pin.
+ */
+static void sample_debounce_end(uint32_t pin)
+{
+    app_timer_stop(m_sample_timer);
+
+    // Enable sensing event from MAG_INT_PIN input pin.
+    nrfx_gpiote_in_event_enable(pin, true);
+}
+
+/**@brief       Start a single measurement, completed by measure_complete() on DRDY.
+ *
+ * @retval  True if the measurement started.
+ */
+static bool measure_trigger(void)
+{
+    lsm303agr_mag_raw_t discard;
+
+    if (m_measuring || (m_config.md != LSM303AGR_MODE_IDLE) || lsm303agr_mag_stream_is_running()) {
+        return false;
+    }
+
+    // DRDY of an unread sample is still high and would hide the rising edge.
+    if (nrf_gpio_pin_read(MAG_INT_PIN) && !lsm303agr_mag_read_raw(&discard)) {
+        return false;
+    }
+
+    // DRDY on the pin, the comparator is not needed.
+    lsm303agr_mag_config_t config = m_config;
+    config.md                     = LSM303AGR_MODE_SINGLE;
+    config.int_ctrl.IEN           = LSM303AGR_DISABLE;
+    config.int_on_pin             = LSM303AGR_DISABLE;
+    config.drdy_on_pin            = LSM303AGR_ENABLE;
+
+    m_measuring  = true;
+    m_measure_ok = false;
+    nrfx_gpiote_in_event_enable(MAG_INT_PIN, true);
+
+    if (!lsm303agr_mag_apply_config(&config, false)) {
+        nrfx_gpiote_in_event_disable(MAG_INT_PIN);
+        m_measuring = false;
+        return false;
+    }
+
+    app_timer_start(m_measure_timer, APP_TIMER_TICKS(MAGNETOMETER_MEASURE_TIMEOUT_MS), NULL);
+
+    return true;
+}
+
+/**@brief       Read the sample of a single measurement, the device is back in idle mode.
+ *
+ * @param[in]   pin       -   Interrupt pin.
+ */
+static void measure_complete(uint32_t pin)
+{
+    // Falling edge caused by the output read.
+    if (!nrf_gpio_pin_read(pin)) {
+        return;
+    }
+
+    nrfx_gpiote_in_event_disable(pin);
+    app_timer_stop(m_measure_timer);
 
-    // Default: 0 If IEA = 0, then INT = 0 signals an interrupt. If IEA = 1, then INT = 1 signals an interrupt.
-    return state ? MAGNETOMETER_EVENT_MAGNET_DETECTED : MAGNETOMETER_EVENT_MAGNET_NOT_DETECTED;
+    m_measure_ok = lsm303agr_mag_read_raw(&m_measure_sample);
+    m_measuring  = false;
+
+    if (m_measure_ok) {
+        magnetometer_ellipsoid_apply(&m_correction, &m_measure_sample, &m_measure_sample);
+    }
+
+    if (m_measure_periodic && m_measure_ok) {
+        event_emit(MAGNETOMETER_EVENT_SAMPLE, &m_measure_sample, 0);
+    }
 }
 
-bool magnetometer_init(magnetometer_handler_t handler)
+/** Abandon a single measurement in progress. */
+static void measure_abort(void)
+{
+    app_timer_stop(m_measure_periodic_timer);
+    app_timer_stop(m_measure_timer);
+    m_measure_periodic = false;
+    m_measuring        = false;
+}
+
+bool magnetometer_init(void)
 {
     nrfx_err_t err_code;
 
-    ASSERT(handler);
-    m_event_handler = handler;
+    magnetometer_ellipsoid_identity(&m_correction);
 
     // Initialize lsm303.
     m_lsm303_flag = lsm303agr_mag_init();
@@ -54,14 +510,44 @@ bool magnetometer_init(magnetometer_handler_t handler)
     err_code = app_timer_create(&m_magnetometer_timer, APP_TIMER_MODE_SINGLE_SHOT, magnetometer_timer_handler);
     APP_ERROR_CHECK(err_code);
 
-    // Restart LSM303.
-    magnetometer_reset();
+    err_code = app_timer_create(&m_sample_timer, APP_TIMER_MODE_REPEATED, magnetometer_sample_timer_handler);
+    APP_ERROR_CHECK(err_code);
 
-    return true;
+    err_code = app_timer_create(&m_poll_timer, APP_TIMER_MODE_REPEATED, magnetometer_poll_timer_handler);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = app_timer_create(&m_release_timer, APP_TIMER_MODE_SINGLE_SHOT, magnetometer_release_timer_handler);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = app_timer_create(&m_calibration_timer, APP_TIMER_MODE_SINGLE_SHOT, magnetometer_calibration_timer_handler);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = app_timer_create(&m_measure_timer, APP_TIMER_MODE_SINGLE_SHOT, magnetometer_measure_timer_handler);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = app_timer_create(&m_measure_periodic_timer, APP_TIMER_MODE_REPEATED, magnetometer_measure_periodic_timer_handler);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = app_timer_create(&m_settings_timer, APP_TIMER_MODE_SINGLE_SHOT, magnetometer_settings_timer_handler);
+    APP_ERROR_CHECK(err_code);
+
+    // Restart LSM303.
+    return magnetometer_reset();
 }
 
-void magnetometer_reset(void)
+bool magnetometer_reset(void)
 {
+    const lsm303agr_bus_t *p_bus = lsm303agr_bus_get();
+    bool                   ret   = true;
+
+    // lsm303agr_init() may have failed, there is no bus to reset the device on.
+    if (p_bus == NULL) {
+        NRFX_LOG_WARNING("%s No bus selected.", __func__);
+        return false;
+    }
+
+    PROFILE_BEGIN(MAG_RESET);
+
     // Restore default configuration for magnetometer.
     lsm303agr_enable_t rst = LSM303AGR_ENABLE;
     lsm303agr_mag_set_soft_reset(rst);
@@ -73,83 +559,630 @@ void magnetometer_reset(void)
         rst = lsm303agr_mag_get_soft_reset();
     }
 
-    // Set device to idle mode.
-    lsm303agr_mag_set_md(LSM303AGR_MODE_IDLE);
+    // Write the whole profile in idle mode, I2C is inhibited on the SPI bus.
+    m_config.md      = LSM303AGR_MODE_IDLE;
+    m_config.i2c_dis = (p_bus->type == LSM303AGR_BUS_SPIM) ? LSM303AGR_ENABLE : LSM303AGR_DISABLE;
+    if (!lsm303agr_mag_apply_config(&m_config, true)) {
+        NRFX_LOG_WARNING("%s Configuration failed.", __func__);
+        ret = false;
+    }
 
-    // Set data rate.
-    lsm303agr_mag_set_odr(LSM303AGR_ODR_10);
+    // Soft reset clears the hard-iron offset.
+    lsm303agr_mag_raw_t offset = {0};
+    magnetometer_baseline_init(&m_baseline, &offset);
 
-    // For proper operation, this bit must be set to 1.
-    lsm303agr_mag_set_comp_temp(LSM303AGR_ENABLE);
+    PROFILE_END(MAG_RESET);
+
+    return ret;
 }
 
-void magnetometer_start(void)
+bool magnetometer_set_thresholds(int16_t assert_ths, int16_t release_ths)
 {
-    lsm303agr_int_cntl_t int_ctrl = {.IEN  = LSM303AGR_ENABLE,    // Enables interrupt.
-                                     .ZIEN = LSM303AGR_ENABLE,    // Enables interrupt for z-axis.
-                                     .YIEN = LSM303AGR_ENABLE,    // Enables interrupt for y-axis.
-                                     .XIEN = LSM303AGR_ENABLE,    // Enables interrupt for x-axis.
-                                     .IEL  = LSM303AGR_INT_PULSE, // Pulsed interrupt.
-                                     .IEA  = LSM303AGR_INT_HIGH};
+    if ((assert_ths <= 0) || (release_ths <= 0) || (release_ths > assert_ths)) {
+        return false;
+    }
+
+    // Both change together for the interrupt handlers.
+    CRITICAL_REGION_ENTER();
+    m_threshold_assert  = assert_ths;
+    m_threshold_release = release_ths;
+    CRITICAL_REGION_EXIT();
+
+    // Magnet state and INT_THS belong to the interrupt handlers, the threshold is applied at their priority.
+    app_timer_start(m_settings_timer, APP_TIMER_MIN_TIMEOUT_TICKS, NULL);
 
+    return true;
+}
+
+bool magnetometer_register(magnetometer_handler_t handler, uint32_t filter)
+{
+    ASSERT(handler);
+
+    if (m_subscriber_count == MAGNETOMETER_MAX_SUBSCRIBERS) {
+        NRFX_LOG_WARNING("%s Subscriber table is full.", __func__);
+        return false;
+    }
+
+    m_subscribers[m_subscriber_count].handler = handler;
+    m_subscribers[m_subscriber_count].filter  = filter;
+    m_subscriber_count++;
+
+    return true;
+}
+
+void magnetometer_set_debounce(magnetometer_debounce_t mode) { m_debounce_mode = mode; }
+
+bool magnetometer_set_latency_budget(uint32_t budget_ms)
+{
+    uint32_t previous = m_latency_budget_ms;
+
+    // Adaptive rate may fall back to the slowest band, the budget must hold there.
+    m_latency_budget_ms = budget_ms;
+    if (confirm_samples_at(m_adaptive_odr ? LSM303AGR_ODR_10 : m_config.odr) == 0) {
+        m_latency_budget_ms = previous;
+        return false;
+    }
+
+    return true;
+}
+
+void magnetometer_set_adaptive_odr(bool enable)
+{
+    m_adaptive_odr = enable;
+
+    // Rate of m_config belongs to the poll handler, the profile rate is restored at its priority.
+    if (!enable) {
+        app_timer_start(m_settings_timer, APP_TIMER_MIN_TIMEOUT_TICKS, NULL);
+    }
+}
+
+bool magnetometer_calibrate(uint32_t window_ms)
+{
+    lsm303agr_mag_raw_t zero = {0};
+
+    if (m_calibrating || m_cal_solving || (m_config.md != LSM303AGR_MODE_CONTINUOUS)) {
+        return false;
+    }
+
+    // Field is collected without offset, the current one is kept for a failed calibration.
+    if (!lsm303agr_mag_get_offset(&m_cal_restore) || !lsm303agr_mag_set_offset(&zero)) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < 3; i++) {
+        m_cal_min[i] = INT16_MAX;
+        m_cal_max[i] = INT16_MIN;
+    }
+    magnetometer_ellipsoid_init(&m_cal_fit);
+
+    m_calibrating = true;
+
+    // Collect one sample per output period.
+    poll_restart();
+    app_timer_start(m_calibration_timer, APP_TIMER_TICKS(window_ms), NULL);
+
+    return true;
+}
+
+void magnetometer_set_correction(const magnetometer_ellipsoid_correction_t *p_corr)
+{
+    // Samples are corrected from interrupt context.
+    CRITICAL_REGION_ENTER();
+    m_correction = *p_corr;
+    CRITICAL_REGION_EXIT();
+}
+
+void magnetometer_get_correction(magnetometer_ellipsoid_correction_t *p_corr)
+{
+    CRITICAL_REGION_ENTER();
+    *p_corr = m_correction;
+    CRITICAL_REGION_EXIT();
+}
+
+bool magnetometer_measure_once(lsm303agr_mag_raw_t *p_sample)
+{
     APP_ERROR_CHECK_BOOL(m_lsm303_flag);
 
-    // Set interrupt threshold.
-    lsm303agr_mag_set_int_threshold(MAGNETOMETER_THRESHOLD_VALUE);
+    if (m_measure_periodic || !measure_trigger()) {
+        return false;
+    }
 
-    // Enable interrupt on MAG_PIN.
-    lsm303agr_mag_set_int_on_pin(LSM303AGR_ENABLE);
+    // DRDY and the timeout both wake the core from their interrupts.
+    while (m_measuring) {
+        __WFE();
+    }
+
+    if (!m_measure_ok) {
+        return false;
+    }
+
+    *p_sample = m_measure_sample;
+
+    return true;
+}
+
+bool magnetometer_measure_periodic_start(uint32_t period_ms)
+{
+    APP_ERROR_CHECK_BOOL(m_lsm303_flag);
+
+    if (m_measure_periodic || (m_config.md != LSM303AGR_MODE_IDLE) || (period_ms <= MAGNETOMETER_MEASURE_TIMEOUT_MS)) {
+        return false;
+    }
+
+    m_measure_periodic = true;
+    app_timer_start(m_measure_periodic_timer, APP_TIMER_TICKS(period_ms), NULL);
+
+    return true;
+}
+
+void magnetometer_measure_periodic_stop(void) { measure_abort(); }
+
+void magnetometer_set_baseline_tracking(bool enable) { m_baseline_tracking = enable; }
+
+void magnetometer_set_int_mode(magnetometer_int_mode_t mode) { m_int_mode = mode; }
+
+void magnetometer_start(void)
+{
+    APP_ERROR_CHECK_BOOL(m_lsm303_flag);
+
+    PROFILE_BEGIN(MAG_START);
+
+    // Continuous mode replaces single measurements.
+    measure_abort();
+
+    // Adaptive rate starts from the slowest band, the profile rate otherwise.
+    if (m_adaptive_odr) {
+        m_config.odr = LSM303AGR_ODR_10;
+        m_config.lp  = magnetometer_odr_lp(m_config.odr);
+        magnetometer_odr_init(&m_odr_policy, m_config.odr);
+    } else {
+        m_config.odr = m_profile_odr;
+        m_config.lp  = m_profile_lp;
+    }
 
-    // Set MAG_PIN as an output.
-    lsm303agr_mag_set_drdy_on_pin(LSM303AGR_ENABLE);
+    // Latched INT is held until INT_SOURCE_REG_M is read, DRDY must not share the pin with it.
+    m_config.int_ctrl.IEL = (m_int_mode == MAGNETOMETER_INT_LATCHED) ? LSM303AGR_INT_LATCH : LSM303AGR_INT_PULSE;
+    m_config.drdy_on_pin  = (m_int_mode == MAGNETOMETER_INT_LATCHED) ? LSM303AGR_DISABLE : LSM303AGR_ENABLE;
+    m_confirm_count       = 0;
 
-    // Enable interrupt recognition for the Z-axis.
-    lsm303agr_mag_set_int_ctrl(int_ctrl);
+    // Profile is already on the device, only the mode changes.
+    m_config.md = LSM303AGR_MODE_CONTINUOUS;
+    lsm303agr_mag_apply_config(&m_config, false);
 
-    // Set device to continuous mode.
-    lsm303agr_mag_set_md(LSM303AGR_MODE_CONTINUOUS);
+    // Output is polled for the rate policy and the ambient field estimator.
+    poll_restart();
 
     // Set intial state for the magnet.
     app_timer_start(m_magnetometer_timer, MAGNETOMETER_DEBOUNCE_MS, (uint32_t *)MAG_INT_PIN);
+
+    // Serialize with the interrupt producer.
+    CRITICAL_REGION_ENTER();
+    event_emit(MAGNETOMETER_EVENT_START, NULL, 0);
+    CRITICAL_REGION_EXIT();
+
+    PROFILE_END(MAG_START);
 }
 
 void magnetometer_stop(void)
 {
+    PROFILE_BEGIN(MAG_STOP);
+
     // Disable interrupt.
     nrfx_gpiote_in_event_disable(MAG_INT_PIN);
+    app_timer_stop(m_magnetometer_timer);
+    app_timer_stop(m_sample_timer);
+    app_timer_stop(m_poll_timer);
+    app_timer_stop(m_release_timer);
+    app_timer_stop(m_calibration_timer);
+
+    // Calibration is aborted, a pending fit is dropped.
+    if (m_calibrating || m_cal_solving) {
+        m_calibrating = false;
+        m_cal_solving = false;
+        lsm303agr_mag_set_offset(&m_cal_restore);
+    }
 
     // Restart magnetometer.
     // magnetometer_reset();
 
     // Set device to idle mode.
-    lsm303agr_mag_set_md(LSM303AGR_MODE_IDLE);
+    m_config.md = LSM303AGR_MODE_IDLE;
+    lsm303agr_mag_set_md(m_config.md);
+
+    // Serialize with the interrupt producer.
+    CRITICAL_REGION_ENTER();
+    event_emit(MAGNETOMETER_EVENT_STOP, NULL, 0);
+    CRITICAL_REGION_EXIT();
+
+    PROFILE_END(MAG_STOP);
 }
 
-void magnetometer_gpiote_event_handler(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action)
+/** Return MAG_INT_PIN and the device to threshold detection after streaming, detection resumes if it was running. */
+static void detection_restore(void)
+{
+    nrfx_err_t              err_code;
+    nrfx_gpiote_in_config_t in_config = NRFX_GPIOTE_CONFIG_IN_SENSE_TOGGLE(true);
+
+    nrfx_gpiote_in_event_disable(MAG_INT_PIN);
+    nrfx_gpiote_in_uninit(MAG_INT_PIN);
+    err_code = nrfx_gpiote_in_init(MAG_INT_PIN, &in_config, magnetometer_gpiote_event_handler);
+    APP_ERROR_CHECK(err_code);
+
+    if (!lsm303agr_mag_apply_config(&m_config, false)) {
+        NRFX_LOG_WARNING("%s Configuration failed.", __func__);
+    }
+
+    if (m_config.md != LSM303AGR_MODE_CONTINUOUS) {
+        return;
+    }
+
+    // Polling and the initial state as magnetometer_start() does, the pin event is enabled by the state timer.
+    poll_restart();
+    app_timer_start(m_magnetometer_timer, MAGNETOMETER_DEBOUNCE_MS, (uint32_t *)MAG_INT_PIN);
+}
+
+/**@brief       Apply the soft-iron correction to streamed samples before they reach the handler.
+ *
+ * @param[in]   p_samples -   Samples in acquisition order.
+ * @param[in]   count     -   Number of samples.
+ */
+static void stream_correct(const lsm303agr_mag_raw_t *p_samples, uint16_t count)
+{
+    while (count > 0) {
+        uint16_t chunk = (uint16_t)MIN(count, ARRAY_SIZE(m_stream_samples));
+
+        for (uint16_t i = 0; i < chunk; i++) {
+            magnetometer_ellipsoid_apply(&m_correction, &p_samples[i], &m_stream_samples[i]);
+        }
+        m_stream_handler(m_stream_samples, chunk);
+
+        p_samples += chunk;
+        count -= chunk;
+    }
+}
+
+bool magnetometer_stream_start(lsm303agr_odr_t odr, lsm303agr_mag_stream_handler_t handler)
 {
+    nrfx_err_t              err_code;
+    nrfx_gpiote_in_config_t in_config = NRFX_GPIOTE_CONFIG_IN_SENSE_LOTOHI(true);
+
+    APP_ERROR_CHECK_BOOL(m_lsm303_flag);
+
+    // Threshold detection, single measurements and streaming share MAG_INT_PIN.
+    measure_abort();
+    nrfx_gpiote_in_event_disable(MAG_INT_PIN);
+    app_timer_stop(m_magnetometer_timer);
+    app_timer_stop(m_sample_timer);
+    app_timer_stop(m_poll_timer);
+    app_timer_stop(m_release_timer);
+
+    // Route DRDY to the pin, interrupt generation is not needed.
+    lsm303agr_mag_config_t config = m_config;
+    config.md                     = LSM303AGR_MODE_CONTINUOUS;
+    config.odr                    = odr;
+    config.int_ctrl.IEN           = LSM303AGR_DISABLE;
+    config.int_on_pin             = LSM303AGR_DISABLE;
+    config.drdy_on_pin            = LSM303AGR_ENABLE;
+    if (!lsm303agr_mag_apply_config(&config, false)) {
+        detection_restore();
+        return false;
+    }
+
+    // DRDY rising edge only, the event is consumed by PPI.
+    nrfx_gpiote_in_uninit(MAG_INT_PIN);
+    err_code = nrfx_gpiote_in_init(MAG_INT_PIN, &in_config, NULL);
+    APP_ERROR_CHECK(err_code);
+
+    nrfx_gpiote_in_event_enable(MAG_INT_PIN, false);
+
+    // Bus busy or not TWIM, detection goes on as before.
+    m_stream_handler = handler;
+    if (!lsm303agr_mag_stream_start(nrfx_gpiote_in_event_addr_get(MAG_INT_PIN), MAG_INT_PIN, stream_correct)) {
+        detection_restore();
+        return false;
+    }
+
+    return true;
+}
+
+void magnetometer_stream_stop(void)
+{
+    lsm303agr_mag_stream_stop();
+
+    // Restore threshold detection configuration in idle mode.
+    m_config.md = LSM303AGR_MODE_IDLE;
+    detection_restore();
+}
+
+/**@brief       Route a MAG_INT_PIN edge by the current operation.
+ *
+ * @param[in]   pin       -   Interrupt pin.
+ */
+static void gpiote_event_handle(uint32_t pin)
+{
+    if (m_measuring) {
+        measure_complete(pin);
+        return;
+    }
+
+    if (latched_holding()) {
+        latched_hold_edge(pin);
+        return;
+    }
+
+    if (m_int_mode == MAGNETOMETER_INT_LATCHED) {
+        latched_int_handle(pin);
+        return;
+    }
+
     // Disable sensing event from MAG_INT_PIN input pint.
     nrfx_gpiote_in_event_disable(pin);
 
-    // Start debounce timer.
-    app_timer_start(m_magnetometer_timer, MAGNETOMETER_DEBOUNCE_MS, (uint32_t *)pin);
+    if (m_debounce_mode == MAGNETOMETER_DEBOUNCE_TIME) {
+        // Start debounce timer.
+        app_timer_start(m_magnetometer_timer, MAGNETOMETER_DEBOUNCE_MS, (uint32_t *)pin);
+        return;
+    }
+
+    // K follows the current ODR.
+    m_confirm_samples = confirm_samples();
+    m_confirm_count   = 0;
+
+    // Sample the comparator once per output period.
+    app_timer_start(m_sample_timer, APP_TIMER_TICKS(1000 / magnetometer_odr_hz(m_config.odr)), (uint32_t *)pin);
+}
+
+void magnetometer_gpiote_event_handler(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action)
+{
+    PROFILE_BEGIN(MAG_GPIOTE);
+
+    gpiote_event_handle(pin);
+
+    PROFILE_END(MAG_GPIOTE);
 }
 
 static void magnetometer_timer_handler(void *p_context)
 {
-    uint32_t pin = (uint32_t)p_context;
+    uint32_t               pin = (uint32_t)p_context;
+    lsm303agr_int_source_t source;
 
     // Enable sensing event from MAG_INT_PIN input pin.
     nrfx_gpiote_in_event_enable(pin, true);
 
-    // Get magnet current state.
-    magnetometer_event_t event = get_current_event(pin);
-    if (m_last_event == event) {
+    // Held detection restored after streaming, the pin level tells whether the magnet is still present.
+    if (latched_holding()) {
+        latched_hold_edge(pin);
         return;
     }
 
-    // Set last event to current event.
-    m_last_event = event;
+    // Get magnet current state, axis and side in one byte read.
+    if (!lsm303agr_mag_read_int_source(&source)) {
+        return;
+    }
 
-    // Report new magnet state.
-    m_event_handler(event);
-}
\ No newline at end of file
+    // A detection is kept alive by the latched interrupts that follow.
+    if ((m_int_mode == MAGNETOMETER_INT_LATCHED) && source.INT) {
+        latched_sample(source);
+        return;
+    }
+
+    state_report(get_current_event(source), source);
+}
+
+static void magnetometer_sample_timer_handler(void *p_context)
+{
+    uint32_t               pin = (uint32_t)p_context;
+    lsm303agr_int_source_t source;
+
+    // Comparator result of the latest sample, a failed read is not counted.
+    if (!lsm303agr_mag_read_int_source(&source)) {
+        return;
+    }
+
+    magnetometer_event_t event = get_current_event(source);
+
+    // State returned before it was confirmed, the edge was a glitch.
+    if (event == m_last_event) {
+        sample_debounce_end(pin);
+        return;
+    }
+
+    if (++m_confirm_count < m_confirm_samples) {
+        return;
+    }
+
+    sample_debounce_end(pin);
+    state_report(event, source);
+}
+
+static void magnetometer_poll_timer_handler(void *p_context)
+{
+    lsm303agr_mag_raw_t sample;
+    uint32_t            period_ms = poll_period_ms();
+
+    if (!lsm303agr_mag_read_raw(&sample)) {
+        return;
+    }
+
+    // Rate and offset are frozen during calibration, until its fit is applied.
+    if (m_calibrating) {
+        for (uint8_t i = 0; i < 3; i++) {
+            m_cal_min[i] = MIN(m_cal_min[i], sample.axis[i]);
+            m_cal_max[i] = MAX(m_cal_max[i], sample.axis[i]);
+        }
+        magnetometer_ellipsoid_add(&m_cal_fit, &sample);
+        return;
+    }
+
+    if (m_cal_solving) {
+        return;
+    }
+
+    // Ambient field is learned only while no magnet is present.
+    if (m_baseline_tracking && (m_last_event != MAGNETOMETER_EVENT_MAGNET_DETECTED)) {
+        lsm303agr_mag_raw_t offset;
+
+        // Device subtracts the new offset from the output and, with INT_on_DataOFF, from the comparator input.
+        if (magnetometer_baseline_update(&m_baseline, &sample, m_threshold_release, period_ms, &offset) &&
+            !lsm303agr_mag_set_offset(&offset)) {
+            NRFX_LOG_WARNING("%s Offset write failed.", __func__);
+        }
+    }
+
+    if (!m_adaptive_odr || !magnetometer_odr_update(&m_odr_policy, &sample, m_config.int_threshold, period_ms)) {
+        return;
+    }
+
+    // Rate and low-power mode share CFG_REG_A_M, the shadow writes it in one transaction.
+    m_config.odr = m_odr_policy.odr;
+    m_config.lp  = magnetometer_odr_lp(m_config.odr);
+    if (!lsm303agr_mag_apply_config(&m_config, false)) {
+        NRFX_LOG_WARNING("%s Output data rate change failed.", __func__);
+    }
+
+    // Poll at the new rate.
+    poll_restart();
+}
+
+static void magnetometer_release_timer_handler(void *p_context)
+{
+    lsm303agr_int_source_t source = {0};
+
+    // INT inactive for the window releases a held detection.
+    if (latched_holding()) {
+        if ((m_last_event != MAGNETOMETER_EVENT_MAGNET_DETECTED) || (nrf_gpio_pin_read(MAG_INT_PIN) != MAGNETOMETER_INT_IEA)) {
+            latched_release();
+        }
+        return;
+    }
+
+    // A latch left set by a failed read produces no edge, service it now.
+    if (nrf_gpio_pin_read(MAG_INT_PIN) == MAGNETOMETER_INT_IEA) {
+        latched_int_handle(MAG_INT_PIN);
+        return;
+    }
+
+    // No sample exceeded the threshold within the window.
+    m_confirm_count = 0;
+    state_report(MAGNETOMETER_EVENT_MAGNET_NOT_DETECTED, source);
+}
+
+/**@brief       Fit the calibration window and program the offset, scheduler handler running in the main loop.
+ *
+ */
+static void calibration_solve(void *p_event_data, uint16_t event_size)
+{
+    lsm303agr_mag_raw_t                 offset;
+    magnetometer_ellipsoid_correction_t correction;
+    bool                                valid = true;
+
+    // Aborted by magnetometer_stop().
+    if (!m_cal_solving) {
+        return;
+    }
+
+    PROFILE_BEGIN(MAG_CAL_SOLVE);
+
+    // Hard-iron offset is the center of the field sphere.
+    for (uint8_t i = 0; i < 3; i++) {
+        if ((int32_t)m_cal_max[i] - m_cal_min[i] < MAGNETOMETER_CALIBRATION_SPAN) {
+            valid = false;
+        }
+
+        offset.axis[i] = (int16_t)(((int32_t)m_cal_max[i] + m_cal_min[i]) / 2);
+    }
+
+    if (!valid) {
+        NRFX_LOG_WARNING("%s Rotation span is too small.", __func__);
+        offset = m_cal_restore;
+    } else if (magnetometer_ellipsoid_solve(&m_cal_fit, &correction)) {
+        // Ellipsoid center is the better hard-iron estimate, the device subtracts it and the matrix corrects the rest.
+        for (uint8_t i = 0; i < 3; i++) {
+            offset.axis[i]       = correction.center[i];
+            correction.center[i] = 0;
+        }
+        magnetometer_set_correction(&correction);
+    } else {
+        // Rotation did not describe an ellipsoid, e.g. it stayed in a plane, the min/max center is kept.
+        NRFX_LOG_WARNING("%s Soft-iron fit failed.", __func__);
+        magnetometer_ellipsoid_identity(&correction);
+        magnetometer_set_correction(&correction);
+    }
+
+    // Device subtracts the offset from now on.
+    if (!lsm303agr_mag_set_offset(&offset)) {
+        valid = false;
+    }
+
+    // The poll handler leaves the estimator alone until the fit is applied.
+    magnetometer_baseline_init(&m_baseline, &offset);
+
+    // Serialize with the interrupt producer.
+    CRITICAL_REGION_ENTER();
+    m_cal_solving = false;
+    event_emit(valid ? MAGNETOMETER_EVENT_CALIBRATED : MAGNETOMETER_EVENT_CALIBRATION_FAILED, &offset, 0);
+    CRITICAL_REGION_EXIT();
+
+    PROFILE_END(MAG_CAL_SOLVE);
+}
+
+static void magnetometer_calibration_timer_handler(void *p_context)
+{
+    m_calibrating = false;
+    m_cal_solving = true;
+
+    // Poll only if it is needed outside the calibration, at its own period.
+    poll_restart();
+
+    // The fit takes milliseconds, it must not hold off MAG_INT_PIN edges at this priority.
+    if (app_sched_event_put(NULL, 0, calibration_solve) != NRF_SUCCESS) {
+        NRFX_LOG_WARNING("%s Scheduler queue is full.", __func__);
+        m_cal_solving = false;
+        lsm303agr_mag_set_offset(&m_cal_restore);
+        event_emit(MAGNETOMETER_EVENT_CALIBRATION_FAILED, &m_cal_restore, 0);
+    }
+}
+
+static void magnetometer_measure_timer_handler(void *p_context)
+{
+    if (!m_measuring) {
+        return;
+    }
+
+    NRFX_LOG_WARNING("%s No DRDY for a single measurement.", __func__);
+
+    nrfx_gpiote_in_event_disable(MAG_INT_PIN);
+    m_measure_ok = false;
+    m_measuring  = false;
+
+    // Device may still be in single mode.
+    lsm303agr_mag_set_md(LSM303AGR_MODE_IDLE);
+}
+
+static void magnetometer_measure_periodic_timer_handler(void *p_context)
+{
+    if (!measure_trigger()) {
+        NRFX_LOG_WARNING("%s Single measurement not started.", __func__);
+    }
+}
+
+static void magnetometer_settings_timer_handler(void *p_context)
+{
+    // Apply to the current state.
+    threshold_update(m_last_event);
+
+    if (m_adaptive_odr || ((m_config.odr == m_profile_odr) && (m_config.lp == m_profile_lp))) {
+        return;
+    }
+
+    // Policy rate is dropped, the profile rate is restored at once if measuring.
+    m_config.odr = m_profile_odr;
+    m_config.lp  = m_profile_lp;
+
+    if ((m_config.md == LSM303AGR_MODE_CONTINUOUS) && !lsm303agr_mag_stream_is_running()) {
+        if (!lsm303agr_mag_apply_config(&m_config, false)) {
+            NRFX_LOG_WARNING("%s Output data rate change failed.", __func__);
+        }
+        poll_restart();
+    }
+}
@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include "lsm303agr_mag_stream.h"
 #include "lsm303agr_types.h"
+#include "magnetometer_ellipsoid.h"
 #include "nrfx_gpiote.h"
 
 typedef enum {
@@ -16,16 +18,143 @@ typedef enum {
     MAGNETOMETER_EVENT_STOP,
     MAGNETOMETER_EVENT_MAGNET_DETECTED,
     MAGNETOMETER_EVENT_MAGNET_NOT_DETECTED,
+    MAGNETOMETER_EVENT_CALIBRATED,         // Hard-iron offset programmed, field holds the offset.
+    MAGNETOMETER_EVENT_CALIBRATION_FAILED, // Rotation did not cover enough field, previous offset restored.
+    MAGNETOMETER_EVENT_SAMPLE,             // Periodic single measurement, field holds the sample.
 } magnetometer_event_t;
 
-// type of the event handler for the magnetometer events
-typedef void (*magnetometer_handler_t)(magnetometer_event_t event);
+typedef enum {
+    MAGNETOMETER_DEBOUNCE_TIME,    // State is read once after a fixed glitch filter delay, the default.
+    MAGNETOMETER_DEBOUNCE_SAMPLES, // State is confirmed by K consecutive samples, K from the latency budget and ODR.
+} magnetometer_debounce_t;
+
+/** Maximum number of event subscribers. */
+#ifndef MAGNETOMETER_MAX_SUBSCRIBERS
+#define MAGNETOMETER_MAX_SUBSCRIBERS 4
+#endif
+
+/** Events waiting for the main loop, power of two. */
+#ifndef MAGNETOMETER_EVT_QUEUE_SIZE
+#define MAGNETOMETER_EVT_QUEUE_SIZE 8
+#endif
+
+/** Subscriber filter bit of an event type. */
+#define MAGNETOMETER_EVT_MASK(type) (1UL << (type))
+#define MAGNETOMETER_EVT_MASK_ALL 0xFFFFFFFFUL
+
+/* Axis flags of an event, same bit positions as INT_SOURCE_REG_M. */
+#define MAGNETOMETER_AXIS_N_Z (1 << 2) //!< Z-axis exceeds the threshold negative side.
+#define MAGNETOMETER_AXIS_N_Y (1 << 3) //!< Y-axis exceeds the threshold negative side.
+#define MAGNETOMETER_AXIS_N_X (1 << 4) //!< X-axis exceeds the threshold negative side.
+#define MAGNETOMETER_AXIS_P_Z (1 << 5) //!< Z-axis exceeds the threshold positive side.
+#define MAGNETOMETER_AXIS_P_Y (1 << 6) //!< Y-axis exceeds the threshold positive side.
+#define MAGNETOMETER_AXIS_P_X (1 << 7) //!< X-axis exceeds the threshold positive side.
+#define MAGNETOMETER_AXIS_MASK (MAGNETOMETER_AXIS_N_Z | MAGNETOMETER_AXIS_N_Y | MAGNETOMETER_AXIS_N_X | \
+                                MAGNETOMETER_AXIS_P_Z | MAGNETOMETER_AXIS_P_Y | MAGNETOMETER_AXIS_P_X)
+
+// Magnetometer event record.
+typedef struct {
+    magnetometer_event_t type;      // Event type.
+    uint32_t             timestamp; // RTC ticks of app_timer_cnt_get().
+    lsm303agr_mag_raw_t  field;     // Field sample at the event, zero if not available.
+    uint8_t              axes;      // MAGNETOMETER_AXIS_* flags, a release carries the flags of its detection.
+} magnetometer_evt_t;
+
+/**
+ * Interrupt modes. Pulsed is the default and the recommended mode: it costs one interrupt per edge plus the debounce.
+ * Latched costs one interrupt and one INT_SOURCE_REG_M read per sample above the assert threshold until a detection
+ * is confirmed, then holds the detection on a pulsed INT, which stays active while the magnet is present, and is
+ * released after two sample periods of inactive INT.
+ */
+typedef enum {
+    MAGNETOMETER_INT_PULSED,  // INT follows each sample, edges are debounced with the pin event disabled.
+    MAGNETOMETER_INT_LATCHED, // INT is latched until INT_SOURCE_REG_M is read, the pin event is never disabled.
+} magnetometer_int_mode_t;
+
+// type of the event handler for the magnetometer events, called from the main loop by app_sched_execute()
+typedef void (*magnetometer_handler_t)(const magnetometer_evt_t *p_evt);
 
 /** Function for initializing LSM303AGR magnetometer device. */
-bool magnetometer_init(magnetometer_handler_t handler);
+bool magnetometer_init(void);
 
-/** Function for reset the magnetometer configuration. */
-void magnetometer_reset(void);
+/**@brief       Function for subscribing to magnetometer events.
+ *
+ * @param[in]   handler   -   Event handler.
+ * @param[in]   filter    -   MAGNETOMETER_EVT_MASK() of the event types delivered to the handler.
+ *
+ * @retval  True if subscribed, false if the subscriber table is full.
+ */
+bool magnetometer_register(magnetometer_handler_t handler, uint32_t filter);
+
+/** Function for reset the magnetometer configuration, false if no bus is selected or the configuration failed. */
+bool magnetometer_reset(void);
+
+/** Function for set the detection thresholds [LSB], release must not exceed assert, INT_THS follows from interrupt context. */
+bool magnetometer_set_thresholds(int16_t assert_ths, int16_t release_ths);
+
+/** Function for select the debounce method of INT pin edges. */
+void magnetometer_set_debounce(magnetometer_debounce_t mode);
+
+/** Function for set the worst-case detection latency of MAGNETOMETER_DEBOUNCE_SAMPLES, false if it is below three
+ *  sample periods of the slowest output data rate in use. */
+bool magnetometer_set_latency_budget(uint32_t budget_ms);
+
+/** Function for enable tracking of the ambient field into the hard-iron offset, applied on the next start. */
+void magnetometer_set_baseline_tracking(bool enable);
+
+/**@brief       Function for calibrating the hard-iron offset, the device must be rotated through all
+ *              orientations during the window.
+ *
+ * @note        Offset is the center of the fitted ellipsoid, or of the per-axis min/max output if the rotation does
+ *              not describe one, the ellipsoid also sets the soft-iron correction. The fit runs in the main loop
+ *              through app_scheduler, the result is reported with MAGNETOMETER_EVENT_CALIBRATED or
+ *              MAGNETOMETER_EVENT_CALIBRATION_FAILED.
+ *
+ * @param[in]   window_ms -   Collection window.
+ *
+ * @retval  True if calibration started, the magnetometer must be started.
+ */
+bool magnetometer_calibrate(uint32_t window_ms);
+
+/**@brief       Function for setting the soft-iron correction, e.g. one stored after a calibration.
+ *
+ * @note        Applied to magnetometer_measure_once(), MAGNETOMETER_EVENT_SAMPLE and streamed samples. The comparator
+ *              checks the field after the hard-iron offset only.
+ *
+ * @param[in]   p_corr    -   Correction, applied to the output after the device offset.
+ */
+void magnetometer_set_correction(const magnetometer_ellipsoid_correction_t *p_corr);
+
+/** Function for getting the soft-iron correction, identity until a calibration fits an ellipsoid. */
+void magnetometer_get_correction(magnetometer_ellipsoid_correction_t *p_corr);
+
+/**@brief       Function for taking one measurement in single mode, the device returns to idle after it.
+ *
+ * @note        The core sleeps until DRDY on MAG_INT_PIN, call from the main loop with the magnetometer stopped.
+ *
+ * @param[out]  p_sample  -   Output sample.
+ *
+ * @retval  True if the sample was read.
+ */
+bool magnetometer_measure_once(lsm303agr_mag_raw_t *p_sample);
+
+/**@brief       Function for taking a single measurement every period, each one is reported with
+ *              MAGNETOMETER_EVENT_SAMPLE.
+ *
+ * @param[in]   period_ms -   Measurement period.
+ *
+ * @retval  True if started, the magnetometer must be stopped.
+ */
+bool magnetometer_measure_periodic_start(uint32_t period_ms);
+
+/** Function for stopping periodic single measurements. */
+void magnetometer_measure_periodic_stop(void);
+
+/** Function for select pulsed or latched interrupt, applied on the next start. */
+void magnetometer_set_int_mode(magnetometer_int_mode_t mode);
+
+/** Function for enable the adaptive output data rate on the next start, disabling restores the profile rate from interrupt context. */
+void magnetometer_set_adaptive_odr(bool enable);
 
 /** Function for start the magnetometer measurement cycle. */
 void magnetometer_start(void);
@@ -33,5 +162,11 @@ void magnetometer_start(void);
 /** Function for stop the magnetometer for minimal power consumption. */
 void magnetometer_stop(void);
 
+/** Function for start hardware sample acquisition, DRDY triggers the reads through PPI, detection is restored on failure. */
+bool magnetometer_stream_start(lsm303agr_odr_t odr, lsm303agr_mag_stream_handler_t handler);
+
+/** Function for stop hardware sample acquisition, the magnetometer is left in idle mode. */
+void magnetometer_stream_stop(void);
+
 /** GPIOTE Pin event handler */
 void magnetometer_gpiote_event_handler(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action);
\ No newline at end of file
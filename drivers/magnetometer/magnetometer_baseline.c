@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "magnetometer_baseline.h"
+
+#include <stdlib.h>
+
+#define Q 16 // Fraction bits of the residual average, a short poll period still moves it.
+
+void magnetometer_baseline_init(magnetometer_baseline_t *p_baseline, const lsm303agr_mag_raw_t *p_offset)
+{
+    for (uint8_t i = 0; i < 3; i++) {
+        p_baseline->residual[i] = 0;
+        p_baseline->offset[i]   = p_offset->axis[i];
+    }
+
+    p_baseline->seeded = false;
+}
+
+bool magnetometer_baseline_update(magnetometer_baseline_t *p_baseline, const lsm303agr_mag_raw_t *p_sample, int16_t limit,
+                                  uint32_t elapsed_ms, lsm303agr_mag_raw_t *p_offset)
+{
+    bool    update = false;
+    int32_t gate   = p_baseline->seeded ? ((int32_t)limit * MAGNETOMETER_BASELINE_GATE_PCT) / 100 : limit;
+
+    for (uint8_t i = 0; i < 3; i++) {
+        if (abs(p_sample->axis[i]) > gate) {
+            return false;
+        }
+    }
+
+    // Weight of the sample follows the time it covers, the seed and a gap longer than the time constant replace the
+    // average.
+    if (!p_baseline->seeded || (elapsed_ms > MAGNETOMETER_BASELINE_TAU_MS)) {
+        elapsed_ms = MAGNETOMETER_BASELINE_TAU_MS;
+    }
+
+    p_baseline->seeded = true;
+
+    for (uint8_t i = 0; i < 3; i++) {
+        // Exponential average, residual += (sample - residual) * elapsed / tau.
+        int64_t error = ((int64_t)p_sample->axis[i] << Q) - p_baseline->residual[i];
+
+        p_baseline->residual[i] += (int32_t)((error * (int64_t)elapsed_ms) / MAGNETOMETER_BASELINE_TAU_MS);
+
+        if (abs(p_baseline->residual[i]) >= (MAGNETOMETER_BASELINE_DEADBAND << Q)) {
+            update = true;
+        }
+    }
+
+    if (!update) {
+        return false;
+    }
+
+    // Move the ambient field into the device offset, the output is centered again.
+    for (uint8_t i = 0; i < 3; i++) {
+        int32_t offset = p_baseline->offset[i] + (p_baseline->residual[i] >> Q);
+
+        p_baseline->offset[i]   = (int16_t)((offset > INT16_MAX) ? INT16_MAX : ((offset < INT16_MIN) ? INT16_MIN : offset));
+        p_baseline->residual[i] = 0;
+        p_offset->axis[i]       = p_baseline->offset[i];
+    }
+
+    return true;
+}
@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include "lsm303agr_types.h"
+
+/** Time constant of the average [ms], independent of the poll rate. */
+#ifndef MAGNETOMETER_BASELINE_TAU_MS
+#define MAGNETOMETER_BASELINE_TAU_MS 8000
+#endif
+
+/** Samples are learned only while every axis is within this percentage of the limit. */
+#ifndef MAGNETOMETER_BASELINE_GATE_PCT
+#define MAGNETOMETER_BASELINE_GATE_PCT 50
+#endif
+
+/** Residual [LSB] the average must reach before the device offset is moved. */
+#ifndef MAGNETOMETER_BASELINE_DEADBAND
+#define MAGNETOMETER_BASELINE_DEADBAND 8
+#endif
+
+// Ambient field estimator state.
+typedef struct {
+    int32_t residual[3]; // Average of the offset-corrected output, Q16 [LSB].
+    int16_t offset[3];   // Hard-iron offset programmed on the device [LSB].
+    bool    seeded;      // Ambient field was taken from the first sample below the limit.
+} magnetometer_baseline_t;
+
+/**@brief       Initialize the estimator.
+ *
+ * @param[out]  p_baseline -   Estimator state.
+ * @param[in]   p_offset   -   Offset currently programmed on the device.
+ */
+void magnetometer_baseline_init(magnetometer_baseline_t *p_baseline, const lsm303agr_mag_raw_t *p_offset);
+
+/**@brief       Feed an offset-corrected output sample taken while no magnet is present.
+ *
+ * @note        The first sample below the limit seeds the ambient field. Later samples with an axis beyond
+ *              MAGNETOMETER_BASELINE_GATE_PCT of the limit are ignored, an approaching magnet must not be learned as
+ *              ambient field. With the release threshold as the limit the gate lies inside the slowest adaptive ODR band.
+ *
+ * @param[in]   p_baseline -   Estimator state.
+ * @param[in]   p_sample   -   Output sample.
+ * @param[in]   limit      -   Release threshold [LSB].
+ * @param[in]   elapsed_ms -   Time since the previous sample.
+ * @param[out]  p_offset   -   New device offset, valid if true is returned.
+ *
+ * @retval  True if the device offset should be updated.
+ */
+bool magnetometer_baseline_update(magnetometer_baseline_t *p_baseline, const lsm303agr_mag_raw_t *p_sample, int16_t limit,
+                                  uint32_t elapsed_ms, lsm303agr_mag_raw_t *p_offset);
@@ -0,0 +1,287 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "magnetometer_ellipsoid.h"
+
+#include <math.h>
+#include <string.h>
+
+#define N MAGNETOMETER_ELLIPSOID_PARAMS
+#define Q 15                  // Fraction bits of the correction matrix.
+#define PIVOT_MIN 1e-12       // Smallest pivot of a solvable system.
+#define JACOBI_SWEEPS 50      // Upper bound of eigenvalue iterations.
+#define JACOBI_EPSILON 1e-15  // Off-diagonal sum of a diagonalized matrix.
+#define AXIS_RATIO_MAX 4.0    // Largest semi-axis ratio of a plausible distortion.
+
+static void regressors_get(const lsm303agr_mag_raw_t *p_sample, float *p_phi)
+{
+    float x = p_sample->x / MAGNETOMETER_ELLIPSOID_SCALE;
+    float y = p_sample->y / MAGNETOMETER_ELLIPSOID_SCALE;
+    float z = p_sample->z / MAGNETOMETER_ELLIPSOID_SCALE;
+
+    p_phi[0] = x * x;
+    p_phi[1] = y * y;
+    p_phi[2] = z * z;
+    p_phi[3] = 2.0f * x * y;
+    p_phi[4] = 2.0f * x * z;
+    p_phi[5] = 2.0f * y * z;
+    p_phi[6] = 2.0f * x;
+    p_phi[7] = 2.0f * y;
+    p_phi[8] = 2.0f * z;
+}
+
+/** Solve the normal equations with Gaussian elimination and partial pivoting. */
+static bool normal_solve(const magnetometer_ellipsoid_t *p_fit, double *p_params)
+{
+    double  a[N][N + 1];
+    uint8_t k = 0;
+
+    // Unpack the upper triangle into an augmented matrix.
+    for (uint8_t i = 0; i < N; i++) {
+        for (uint8_t j = i; j < N; j++, k++) {
+            a[i][j] = p_fit->ata[k];
+            a[j][i] = p_fit->ata[k];
+        }
+        a[i][N] = p_fit->atb[i];
+    }
+
+    for (uint8_t col = 0; col < N; col++) {
+        uint8_t pivot = col;
+
+        for (uint8_t row = col + 1; row < N; row++) {
+            if (fabs(a[row][col]) > fabs(a[pivot][col])) {
+                pivot = row;
+            }
+        }
+
+        if (fabs(a[pivot][col]) < PIVOT_MIN) {
+            return false;
+        }
+
+        if (pivot != col) {
+            double tmp[N + 1];
+            memcpy(tmp, a[col], sizeof(tmp));
+            memcpy(a[col], a[pivot], sizeof(tmp));
+            memcpy(a[pivot], tmp, sizeof(tmp));
+        }
+
+        for (uint8_t row = col + 1; row < N; row++) {
+            double factor = a[row][col] / a[col][col];
+
+            for (uint8_t j = col; j <= N; j++) {
+                a[row][j] -= factor * a[col][j];
+            }
+        }
+    }
+
+    for (int8_t i = N - 1; i >= 0; i--) {
+        double sum = a[i][N];
+
+        for (uint8_t j = i + 1; j < N; j++) {
+            sum -= a[i][j] * p_params[j];
+        }
+        p_params[i] = sum / a[i][i];
+    }
+
+    return true;
+}
+
+/** Eigen decomposition of a symmetric 3x3 matrix with cyclic Jacobi rotations, m = v * diag(d) * v^T. */
+static void jacobi_eigen(double m[3][3], double d[3], double v[3][3])
+{
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            v[i][j] = (i == j) ? 1.0 : 0.0;
+        }
+    }
+
+    for (uint8_t sweep = 0; sweep < JACOBI_SWEEPS; sweep++) {
+        if ((fabs(m[0][1]) + fabs(m[0][2]) + fabs(m[1][2])) < JACOBI_EPSILON) {
+            break;
+        }
+
+        for (uint8_t p = 0; p < 2; p++) {
+            for (uint8_t q = p + 1; q < 3; q++) {
+                if (m[p][q] == 0.0) {
+                    continue;
+                }
+
+                // Rotation angle zeroing m[p][q].
+                double theta = (m[q][q] - m[p][p]) / (2 * m[p][q]);
+                double t     = ((theta >= 0) ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1));
+                double c     = 1 / sqrt(t * t + 1);
+                double s     = t * c;
+
+                for (uint8_t k = 0; k < 3; k++) {
+                    double mkp = m[k][p];
+                    double mkq = m[k][q];
+                    m[k][p]    = c * mkp - s * mkq;
+                    m[k][q]    = s * mkp + c * mkq;
+                }
+                for (uint8_t k = 0; k < 3; k++) {
+                    double mpk = m[p][k];
+                    double mqk = m[q][k];
+                    m[p][k]    = c * mpk - s * mqk;
+                    m[q][k]    = s * mpk + c * mqk;
+                }
+                for (uint8_t k = 0; k < 3; k++) {
+                    double vkp = v[k][p];
+                    double vkq = v[k][q];
+                    v[k][p]    = c * vkp - s * vkq;
+                    v[k][q]    = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    for (uint8_t i = 0; i < 3; i++) {
+        d[i] = m[i][i];
+    }
+}
+
+void magnetometer_ellipsoid_init(magnetometer_ellipsoid_t *p_fit) { memset(p_fit, 0, sizeof(*p_fit)); }
+
+void magnetometer_ellipsoid_add(magnetometer_ellipsoid_t *p_fit, const lsm303agr_mag_raw_t *p_sample)
+{
+    float   phi[N];
+    uint8_t k = 0;
+
+    regressors_get(p_sample, phi);
+
+    for (uint8_t i = 0; i < N; i++) {
+        for (uint8_t j = i; j < N; j++, k++) {
+            p_fit->ata[k] += phi[i] * phi[j];
+        }
+        p_fit->atb[i] += phi[i];
+    }
+
+    p_fit->count++;
+}
+
+bool magnetometer_ellipsoid_solve(const magnetometer_ellipsoid_t *p_fit, magnetometer_ellipsoid_correction_t *p_corr)
+{
+    double p[N];
+
+    if ((p_fit->count < MAGNETOMETER_ELLIPSOID_MIN_SAMPLES) || !normal_solve(p_fit, p)) {
+        return false;
+    }
+
+    double m[3][3] = {{p[0], p[3], p[4]}, {p[3], p[1], p[5]}, {p[4], p[5], p[2]}};
+    double v[3]    = {p[6], p[7], p[8]};
+
+    // Center is -M^-1 * v, the inverse by cofactors.
+    double cof[3][3];
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            uint8_t i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+            uint8_t j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+            cof[i][j]  = m[i1][j1] * m[i2][j2] - m[i1][j2] * m[i2][j1];
+        }
+    }
+
+    double det = m[0][0] * cof[0][0] + m[0][1] * cof[0][1] + m[0][2] * cof[0][2];
+    if (fabs(det) < PIVOT_MIN) {
+        return false;
+    }
+
+    double center[3];
+    for (uint8_t i = 0; i < 3; i++) {
+        // M is symmetric, the inverse is cof / det.
+        center[i] = -(cof[i][0] * v[0] + cof[i][1] * v[1] + cof[i][2] * v[2]) / det;
+    }
+
+    // (x - c)^T * M * (x - c) = 1 + c^T * M * c.
+    double scale = 1;
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            scale += center[i] * m[i][j] * center[j];
+        }
+    }
+
+    // M and the scale change sign together when the origin lies outside the ellipsoid, their ratio does not. Zero is
+    // an ellipsoid through the origin, which the fit can not describe.
+    if (fabs(scale) < PIVOT_MIN) {
+        return false;
+    }
+
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            m[i][j] /= scale;
+        }
+    }
+
+    // Eigenvalues are 1 / semi-axis^2, all positive for an ellipsoid.
+    double d[3], e[3][3];
+    jacobi_eigen(m, d, e);
+
+    if ((d[0] <= 0) || (d[1] <= 0) || (d[2] <= 0)) {
+        return false;
+    }
+
+    double d_min = fmin(d[0], fmin(d[1], d[2]));
+    double d_max = fmax(d[0], fmax(d[1], d[2]));
+    if (d_max / d_min > AXIS_RATIO_MAX * AXIS_RATIO_MAX) {
+        return false;
+    }
+
+    // Radius of the sphere with the ellipsoid volume keeps the field magnitude in LSB.
+    double radius = cbrt(1 / sqrt(d[0] * d[1] * d[2]));
+
+    for (uint8_t i = 0; i < 3; i++) {
+        double c = center[i] * MAGNETOMETER_ELLIPSOID_SCALE;
+
+        if ((c > INT16_MAX) || (c < INT16_MIN)) {
+            return false;
+        }
+        p_corr->center[i] = (int16_t)lround(c);
+    }
+
+    // W = radius * E * sqrt(D) * E^T maps the ellipsoid on the sphere without rotating it.
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            double w = 0;
+
+            for (uint8_t k = 0; k < 3; k++) {
+                w += e[i][k] * sqrt(d[k]) * e[j][k];
+            }
+            p_corr->matrix[i][j] = (int32_t)lround(radius * w * (1 << Q));
+        }
+    }
+
+    return true;
+}
+
+void magnetometer_ellipsoid_identity(magnetometer_ellipsoid_correction_t *p_corr)
+{
+    for (uint8_t i = 0; i < 3; i++) {
+        p_corr->center[i] = 0;
+
+        for (uint8_t j = 0; j < 3; j++) {
+            p_corr->matrix[i][j] = (i == j) ? (1 << Q) : 0;
+        }
+    }
+}
+
+void magnetometer_ellipsoid_apply(const magnetometer_ellipsoid_correction_t *p_corr, const lsm303agr_mag_raw_t *p_in,
+                                  lsm303agr_mag_raw_t *p_out)
+{
+    int32_t centered[3];
+
+    for (uint8_t i = 0; i < 3; i++) {
+        centered[i] = (int32_t)p_in->axis[i] - p_corr->center[i];
+    }
+
+    for (uint8_t i = 0; i < 3; i++) {
+        int64_t acc = (int64_t)1 << (Q - 1); // Rounding.
+
+        for (uint8_t j = 0; j < 3; j++) {
+            acc += (int64_t)p_corr->matrix[i][j] * centered[j];
+        }
+        acc >>= Q;
+
+        p_out->axis[i] = (int16_t)((acc > INT16_MAX) ? INT16_MAX : ((acc < INT16_MIN) ? INT16_MIN : acc));
+    }
+}
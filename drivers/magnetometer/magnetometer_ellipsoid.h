@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include "lsm303agr_types.h"
+
+/** Input scale [LSB], samples are normalized to about unit range before accumulation. */
+#ifndef MAGNETOMETER_ELLIPSOID_SCALE
+#define MAGNETOMETER_ELLIPSOID_SCALE 1024.0f
+#endif
+
+/** Minimal number of samples for a fit. */
+#ifndef MAGNETOMETER_ELLIPSOID_MIN_SAMPLES
+#define MAGNETOMETER_ELLIPSOID_MIN_SAMPLES 50
+#endif
+
+/** Quadric parameters, Ax^2 + By^2 + Cz^2 + 2Dxy + 2Exz + 2Fyz + 2Gx + 2Hy + 2Iz = 1. */
+#define MAGNETOMETER_ELLIPSOID_PARAMS 9
+
+// Least-squares sufficient statistics, independent of the number of samples. Single precision runs on the FPU of the
+// Cortex-M4F, a sample costs 45 multiply-adds and 9 additions.
+typedef struct {
+    float    ata[MAGNETOMETER_ELLIPSOID_PARAMS * (MAGNETOMETER_ELLIPSOID_PARAMS + 1) / 2]; // Upper triangle of sum(phi * phi^T).
+    float    atb[MAGNETOMETER_ELLIPSOID_PARAMS];                                          // sum(phi).
+    uint32_t count;                                                                        // Number of samples.
+} magnetometer_ellipsoid_t;
+
+// Fixed-point correction, out = matrix * (in - center).
+typedef struct {
+    int16_t center[3];    // Hard-iron offset [LSB].
+    int32_t matrix[3][3]; // Soft-iron correction, Q15.
+} magnetometer_ellipsoid_correction_t;
+
+/** Function for clearing the statistics. */
+void magnetometer_ellipsoid_init(magnetometer_ellipsoid_t *p_fit);
+
+/**@brief       Accumulate an output sample, the device should be rotated through all orientations.
+ *
+ * @param[in]   p_fit    -   Fit statistics.
+ * @param[in]   p_sample -   Output sample.
+ */
+void magnetometer_ellipsoid_add(magnetometer_ellipsoid_t *p_fit, const lsm303agr_mag_raw_t *p_sample);
+
+/**@brief       Fit the ellipsoid and derive the correction mapping it on a sphere of the same volume.
+ *
+ * @note        Solved once per calibration in double precision, which the Cortex-M4F runs in software. The
+ *              elimination and the eigen decomposition take in the order of a thousand double operations, roughly
+ *              100k cycles or 2 ms at 64 MHz (estimated, not measured), and about 1 kB of stack.
+ *
+ * @param[in]   p_fit  -   Fit statistics.
+ * @param[out]  p_corr -   Correction, valid if true is returned.
+ *
+ * @retval  True if the samples describe an ellipsoid.
+ */
+bool magnetometer_ellipsoid_solve(const magnetometer_ellipsoid_t *p_fit, magnetometer_ellipsoid_correction_t *p_corr);
+
+/** Function for setting a correction that passes samples unchanged. */
+void magnetometer_ellipsoid_identity(magnetometer_ellipsoid_correction_t *p_corr);
+
+/**@brief       Apply the correction to a sample, the output saturates to the sample range.
+ *
+ * @param[in]   p_corr -   Correction.
+ * @param[in]   p_in   -   Output sample.
+ * @param[out]  p_out  -   Corrected sample, may be p_in.
+ */
+void magnetometer_ellipsoid_apply(const magnetometer_ellipsoid_correction_t *p_corr, const lsm303agr_mag_raw_t *p_in,
+                                  lsm303agr_mag_raw_t *p_out);
@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "magnetometer_odr.h"
+
+#include <stdlib.h>
+
+/**@brief       Output data rate band of a sample.
+ *
+ * @param[in]   p_sample  -   Output sample.
+ * @param[in]   threshold -   Active comparator threshold [LSB].
+ *
+ * @retval  Output data rate of the band.
+ */
+static lsm303agr_odr_t odr_band(const lsm303agr_mag_raw_t *p_sample, int16_t threshold)
+{
+    int32_t field = 0;
+
+    // The comparator trips on any axis, the strongest one is the closest to the threshold.
+    for (uint8_t i = 0; i < 3; i++) {
+        int32_t value = abs(p_sample->axis[i]);
+        if (value > field) {
+            field = value;
+        }
+    }
+
+    // Distance from the threshold in percent.
+    int32_t distance = (abs(field - threshold) * 100) / ((threshold > 0) ? threshold : 1);
+
+    if (distance <= 10) {
+        return LSM303AGR_ODR_100;
+    } else if (distance <= 25) {
+        return LSM303AGR_ODR_50;
+    } else if (distance <= 50) {
+        return LSM303AGR_ODR_20;
+    }
+
+    return LSM303AGR_ODR_10;
+}
+
+void magnetometer_odr_init(magnetometer_odr_t *p_policy, lsm303agr_odr_t odr)
+{
+    p_policy->odr      = odr;
+    p_policy->quiet_ms = 0;
+}
+
+bool magnetometer_odr_update(magnetometer_odr_t *p_policy, const lsm303agr_mag_raw_t *p_sample, int16_t threshold, uint32_t elapsed_ms)
+{
+    lsm303agr_odr_t band = odr_band(p_sample, threshold);
+
+    // Approaching the threshold, speed up at once.
+    if (band >= p_policy->odr) {
+        p_policy->quiet_ms = 0;
+
+        if (band == p_policy->odr) {
+            return false;
+        }
+
+        p_policy->odr = band;
+        return true;
+    }
+
+    // Far from the threshold, slow down one band per quiet interval.
+    p_policy->quiet_ms += elapsed_ms;
+    if (p_policy->quiet_ms < MAGNETOMETER_ODR_QUIET_MS) {
+        return false;
+    }
+
+    p_policy->quiet_ms = 0;
+    p_policy->odr--;
+
+    return true;
+}
+
+lsm303agr_lp_t magnetometer_odr_lp(lsm303agr_odr_t odr) { return (odr == LSM303AGR_ODR_10) ? LSM303AGR_LP_LOW : LSM303AGR_LP_HIGH; }
+
+uint32_t magnetometer_odr_hz(lsm303agr_odr_t odr)
+{
+    switch (odr) {
+    case LSM303AGR_ODR_20:
+        return 20;
+    case LSM303AGR_ODR_50:
+        return 50;
+    case LSM303AGR_ODR_100:
+        return 100;
+    case LSM303AGR_ODR_10:
+    default:
+        return 10;
+    }
+}
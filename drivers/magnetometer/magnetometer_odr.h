@@ -0,0 +1,47 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include "lsm303agr_types.h"
+
+/** Time the field must stay in a slower band before the ODR steps down one band. */
+#ifndef MAGNETOMETER_ODR_QUIET_MS
+#define MAGNETOMETER_ODR_QUIET_MS 1000
+#endif
+
+// Adaptive output data rate policy state.
+typedef struct {
+    lsm303agr_odr_t odr;      // Current output data rate.
+    uint32_t        quiet_ms; // Time the field has been in a slower band than the current one.
+} magnetometer_odr_t;
+
+/**@brief       Initialize the policy.
+ *
+ * @param[out]  p_policy  -   Policy state.
+ * @param[in]   odr       -   Initial output data rate.
+ */
+void magnetometer_odr_init(magnetometer_odr_t *p_policy, lsm303agr_odr_t odr);
+
+/**@brief       Feed a sample, the rate steps up at once and steps down one band after a quiet interval.
+ *
+ * @note        Bands by distance of the field from the threshold: within 10% 100 Hz, 25% 50 Hz, 50% 20 Hz,
+ *              otherwise 10 Hz.
+ *
+ * @param[in]   p_policy   -   Policy state.
+ * @param[in]   p_sample   -   Output sample.
+ * @param[in]   threshold  -   Active comparator threshold [LSB].
+ * @param[in]   elapsed_ms -   Time since the previous sample.
+ *
+ * @retval  True if the output data rate changed.
+ */
+bool magnetometer_odr_update(magnetometer_odr_t *p_policy, const lsm303agr_mag_raw_t *p_sample, int16_t threshold, uint32_t elapsed_ms);
+
+/** Low-power mode of an output data rate, only the slowest rate runs in low-power mode. */
+lsm303agr_lp_t magnetometer_odr_lp(lsm303agr_odr_t odr);
+
+/** Output data rate in Hz. */
+uint32_t magnetometer_odr_hz(lsm303agr_odr_t odr);
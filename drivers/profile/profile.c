@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "profile.h"
+
+#if PROFILE_ENABLED
+
+#include "app_util.h"
+#include "app_util_platform.h"
+#include "nrf_log_ctrl.h"
+
+#include <string.h>
+
+#if defined(__arm__)
+#include "nrf.h"
+#else
+#include <time.h>
+#endif
+
+#define NRF_LOG_MODULE_NAME PROFILE
+#define NRF_LOG_LEVEL 3 // LOG_LEVEL
+#include "nrfx_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define PROFILE_OP_NAME(name) #name,
+
+static const char *const m_names[PROFILE_OP_COUNT] = {PROFILE_OPS(PROFILE_OP_NAME)};
+static profile_stats_t   m_stats[PROFILE_OP_COUNT];
+
+/** Histogram bin of a duration. */
+static uint8_t hist_bin(uint32_t ticks)
+{
+    uint8_t log2 = 0;
+
+    while ((ticks >>= 1) != 0) {
+        log2++;
+    }
+
+    if (log2 < PROFILE_HIST_SHIFT) {
+        return 0;
+    }
+
+    return (uint8_t)MIN(log2 - PROFILE_HIST_SHIFT, PROFILE_HIST_BINS - 1);
+}
+
+void profile_init(void)
+{
+#if defined(__arm__)
+    // Cycle counter runs while the trace unit is enabled.
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    profile_reset();
+}
+
+uint32_t profile_now(void)
+{
+#if defined(__arm__)
+    return DWT->CYCCNT;
+#else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t)(((uint64_t)now.tv_sec * 1000000000ULL) + now.tv_nsec);
+#endif
+}
+
+uint32_t profile_ticks_per_us(void)
+{
+#if defined(__arm__)
+    return SystemCoreClock / 1000000;
+#else
+    return 1000;
+#endif
+}
+
+void profile_record(profile_op_t op, uint32_t ticks)
+{
+    profile_stats_t *p_stats = &m_stats[op];
+
+    CRITICAL_REGION_ENTER();
+    p_stats->count++;
+    p_stats->min = MIN(p_stats->min, ticks);
+    p_stats->max = MAX(p_stats->max, ticks);
+    p_stats->sum += ticks;
+    p_stats->hist[hist_bin(ticks)]++;
+    CRITICAL_REGION_EXIT();
+}
+
+const profile_stats_t *profile_stats_get(profile_op_t op) { return &m_stats[op]; }
+
+void profile_reset(void)
+{
+    CRITICAL_REGION_ENTER();
+    memset(m_stats, 0, sizeof(m_stats));
+    for (uint8_t op = 0; op < PROFILE_OP_COUNT; op++) {
+        m_stats[op].min = UINT32_MAX;
+    }
+    CRITICAL_REGION_EXIT();
+}
+
+void profile_dump(void)
+{
+    NRFX_LOG_INFO("Ticks per us: %u", profile_ticks_per_us());
+
+    for (uint8_t op = 0; op < PROFILE_OP_COUNT; op++) {
+        profile_stats_t stats;
+
+        // Consistent copy, the operation may be measured meanwhile.
+        CRITICAL_REGION_ENTER();
+        stats = m_stats[op];
+        CRITICAL_REGION_EXIT();
+
+        if (stats.count == 0) {
+            continue;
+        }
+
+        NRFX_LOG_INFO("%s n: %u, min: %u, max: %u, mean: %u", m_names[op], stats.count, stats.min, stats.max,
+                      (uint32_t)(stats.sum / stats.count));
+
+        for (uint8_t bin = 0; bin < PROFILE_HIST_BINS; bin++) {
+            if (stats.hist[bin] != 0) {
+                NRFX_LOG_INFO("  >= %u: %u", (uint32_t)((bin == 0) ? 0 : (1UL << (bin + PROFILE_HIST_SHIFT))), stats.hist[bin]);
+            }
+        }
+
+        // Deferred log buffer holds a few operations only.
+        NRF_LOG_FLUSH();
+    }
+}
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include "profile_ops.h"
+
+#include <stdint.h>
+
+/**
+ * Execution time statistics of driver operations. On the target the time base is the DWT cycle counter,
+ * on the host it is the monotonic clock in nanoseconds. All calls compile to nothing unless PROFILE_ENABLED is 1.
+ *
+ *     PROFILE_BEGIN(MAG_START);
+ *     ...
+ *     PROFILE_END(MAG_START);
+ */
+
+/** Enables profiling, set from the project preprocessor definitions. */
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED 0
+#endif
+
+/** Histogram bins, bin i counts durations of 2^(i + PROFILE_HIST_SHIFT) up to twice that, the edge bins are open. */
+#ifndef PROFILE_HIST_BINS
+#define PROFILE_HIST_BINS 16
+#endif
+
+/** Histogram first bin, 2^6 cycles is 1 us at 64 MHz. */
+#ifndef PROFILE_HIST_SHIFT
+#define PROFILE_HIST_SHIFT 6
+#endif
+
+#define PROFILE_OP_ENUM(name) PROFILE_OP_##name,
+
+typedef enum {
+    PROFILE_OPS(PROFILE_OP_ENUM)
+
+    PROFILE_OP_COUNT
+} profile_op_t;
+
+#undef PROFILE_OP_ENUM
+
+// Statistics of an operation, in ticks of profile_now().
+typedef struct {
+    uint32_t count;                   // Number of measurements.
+    uint32_t min;                     // Shortest duration.
+    uint32_t max;                     // Longest duration.
+    uint64_t sum;                     // Sum of the durations, mean is sum / count.
+    uint32_t hist[PROFILE_HIST_BINS]; // Logarithmic duration histogram.
+} profile_stats_t;
+
+#if PROFILE_ENABLED
+
+/** Start the time base and clear the statistics. */
+void profile_init(void);
+
+/** Current time in ticks, wraps around. */
+uint32_t profile_now(void);
+
+/** Time base ticks per microsecond. */
+uint32_t profile_ticks_per_us(void);
+
+/**@brief       Add a measurement, may be called from any priority.
+ *
+ * @param[in]   op        -   Operation.
+ * @param[in]   ticks     -   Duration.
+ */
+void profile_record(profile_op_t op, uint32_t ticks);
+
+/** Statistics of an operation. */
+const profile_stats_t *profile_stats_get(profile_op_t op);
+
+/** Clear the statistics. */
+void profile_reset(void);
+
+/** Log the statistics of all measured operations. */
+void profile_dump(void);
+
+#define PROFILE_BEGIN(op) const uint32_t profile_begin_##op = profile_now()
+#define PROFILE_END(op) profile_record(PROFILE_OP_##op, profile_now() - profile_begin_##op)
+
+// Operations ending in another function, the start is kept in a variable declared under PROFILE_ENABLED.
+#define PROFILE_STAMP(var) ((var) = profile_now())
+#define PROFILE_SINCE(op, var) profile_record(PROFILE_OP_##op, profile_now() - (var))
+
+#else
+
+#define profile_init()
+#define profile_reset()
+#define profile_dump()
+
+#define PROFILE_BEGIN(op)
+#define PROFILE_END(op)
+#define PROFILE_STAMP(var)
+#define PROFILE_SINCE(op, var)
+
+#endif
@@ -0,0 +1,18 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** Profiled operations, X(name). */
+#define PROFILE_OPS(X) \
+    X(MAG_START)       \
+    X(MAG_STOP)        \
+    X(MAG_RESET)       \
+    X(MAG_GPIOTE)      \
+    X(MAG_CAL_SOLVE)   \
+    X(BUS_WRITE)       \
+    X(BUS_READ)        \
+    X(BUS_XFER)
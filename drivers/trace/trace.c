@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "trace.h"
+
+#include "SEGGER_RTT.h"
+#include "app_timer.h"
+#include "app_util.h"
+
+#include <string.h>
+
+#define HEADER_SIZE 5 // ID, payload size and 24-bit timestamp.
+
+STATIC_ASSERT(TRACE_ID_COUNT <= TRACE_ID_DATA_FLAG);
+
+static uint8_t           m_buffer[TRACE_BUFFER_SIZE]; // RTT up buffer, read by the debugger.
+static volatile uint32_t m_dropped          = 0;      // Records lost on a full buffer.
+static uint32_t          m_dropped_reported = 0;      // Drop count of the last DROPPED record.
+
+/**@brief       Write a record, the RTT write is atomic so records of different priorities do not mix.
+ *
+ * @param[in]   id        -   Record ID including the data flag.
+ * @param[in]   p_payload -   Payload.
+ * @param[in]   size      -   Payload size in bytes.
+ */
+static void record_write(uint8_t id, const void *p_payload, uint8_t size)
+{
+    uint8_t  record[HEADER_SIZE + MAX(TRACE_MAX_ARGS * sizeof(uint32_t), TRACE_MAX_DATA)];
+    uint32_t timestamp = app_timer_cnt_get();
+
+    record[0] = id;
+    record[1] = size;
+    record[2] = (timestamp >> 0) & 0xFF;
+    record[3] = (timestamp >> 8) & 0xFF;
+    record[4] = (timestamp >> 16) & 0xFF;
+    memcpy(&record[HEADER_SIZE], p_payload, size);
+
+    // Record is skipped as a whole if it does not fit.
+    if (SEGGER_RTT_Write(TRACE_RTT_CHANNEL, record, HEADER_SIZE + size) == 0) {
+        m_dropped++;
+    }
+}
+
+/** Report drops once the buffer has room again. */
+static void dropped_report(void)
+{
+    uint32_t dropped = m_dropped;
+
+    if (dropped != m_dropped_reported) {
+        m_dropped_reported = dropped;
+
+        // Host counts the lost records from here.
+        uint32_t arg = dropped;
+        record_write(TRACE_ID_DROPPED, &arg, sizeof(arg));
+    }
+}
+
+void trace_init(void)
+{
+    SEGGER_RTT_ConfigUpBuffer(TRACE_RTT_CHANNEL, "Trace", m_buffer, sizeof(m_buffer), SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+}
+
+void trace_record(trace_id_t id, const uint32_t *p_args, uint8_t nargs)
+{
+    nargs = MIN(nargs, TRACE_MAX_ARGS);
+
+    // Arguments are little endian on the wire, as in memory.
+    dropped_report();
+    record_write((uint8_t)id, p_args, nargs * sizeof(uint32_t));
+}
+
+void trace_data(trace_id_t id, const void *p_data, uint16_t len)
+{
+    dropped_report();
+    record_write((uint8_t)id | TRACE_ID_DATA_FLAG, p_data, (uint8_t)MIN(len, TRACE_MAX_DATA));
+}
+
+uint32_t trace_dropped_get(void) { return m_dropped; }
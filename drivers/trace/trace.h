@@ -0,0 +1,144 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include "app_util.h"
+#include "trace_ids.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Binary trace of driver hot paths. A record is written to an RTT up channel as an ID and its raw arguments,
+ * formatting is done on the host by tools/trace_decode.py.
+ *
+ * Record layout, little endian:
+ *  - ID, bit 7 set for a data record.
+ *  - Payload size in bytes.
+ *  - Timestamp, 24-bit app_timer ticks.
+ *  - Payload, 32-bit arguments or raw bytes.
+ *
+ * A module selects its level before including this header, calls above it are removed by the preprocessor:
+ *
+ *     #define TRACE_MODULE_LEVEL TRACE_LEVEL_DEBUG
+ *     #include "trace/trace.h"
+ */
+
+#define TRACE_LEVEL_OFF 0
+#define TRACE_LEVEL_ERROR 1
+#define TRACE_LEVEL_WARNING 2
+#define TRACE_LEVEL_INFO 3
+#define TRACE_LEVEL_DEBUG 4
+
+/** Highest level compiled in any module, release builds strip all trace calls. */
+#ifndef TRACE_LEVEL_MAX
+#ifdef NDEBUG
+#define TRACE_LEVEL_MAX TRACE_LEVEL_OFF
+#else
+#define TRACE_LEVEL_MAX TRACE_LEVEL_DEBUG
+#endif
+#endif
+
+/** RTT up channel of the trace, channel 0 is used by the log. */
+#ifndef TRACE_RTT_CHANNEL
+#define TRACE_RTT_CHANNEL 1
+#endif
+
+/** RTT up buffer size in bytes. */
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 1024
+#endif
+
+/** Maximal arguments of a record. */
+#define TRACE_MAX_ARGS 4
+
+/** Maximal bytes of a data record, longer data is truncated. */
+#define TRACE_MAX_DATA 32
+
+/** Data record flag of the record ID. */
+#define TRACE_ID_DATA_FLAG 0x80
+
+#define TRACE_ID_ENUM(name, format) TRACE_ID_##name,
+
+typedef enum {
+    TRACE_IDS(TRACE_ID_ENUM)
+
+    TRACE_ID_COUNT
+} trace_id_t;
+
+#undef TRACE_ID_ENUM
+
+/** Initialize the RTT up channel of the trace. */
+void trace_init(void);
+
+/**@brief       Write an argument record.
+ *
+ * @param[in]   id        -   Record ID.
+ * @param[in]   p_args    -   Arguments.
+ * @param[in]   nargs     -   Number of arguments, up to TRACE_MAX_ARGS.
+ */
+void trace_record(trace_id_t id, const uint32_t *p_args, uint8_t nargs);
+
+/**@brief       Write a data record.
+ *
+ * @param[in]   id        -   Record ID.
+ * @param[in]   p_data    -   Data bytes.
+ * @param[in]   len       -   Data length, truncated to TRACE_MAX_DATA.
+ */
+void trace_data(trace_id_t id, const void *p_data, uint16_t len);
+
+/** Records lost on a full RTT buffer since boot. */
+uint32_t trace_dropped_get(void);
+
+#ifndef TRACE_MODULE_LEVEL
+#define TRACE_MODULE_LEVEL TRACE_LEVEL_OFF
+#endif
+
+// Leading zero keeps the array valid without arguments, the record starts after it.
+#define TRACE_ARGS_(id, ...)                                                                   \
+    do {                                                                                       \
+        const uint32_t trace_args_[] = {0, __VA_ARGS__};                                       \
+        trace_record(TRACE_ID_##id, &trace_args_[1], (uint8_t)(ARRAY_SIZE(trace_args_) - 1)); \
+    } while (0)
+
+#define TRACE_DATA_(id, p_data, len) trace_data(TRACE_ID_##id, (p_data), (len))
+
+#define TRACE_NONE_(...) \
+    do {                 \
+    } while (0)
+
+#if (TRACE_MODULE_LEVEL >= TRACE_LEVEL_ERROR) && (TRACE_LEVEL_MAX >= TRACE_LEVEL_ERROR)
+#define TRACE_ERROR(id, ...) TRACE_ARGS_(id, __VA_ARGS__)
+#define TRACE_ERROR_DATA(id, p_data, len) TRACE_DATA_(id, p_data, len)
+#else
+#define TRACE_ERROR(id, ...) TRACE_NONE_()
+#define TRACE_ERROR_DATA(id, p_data, len) TRACE_NONE_()
+#endif
+
+#if (TRACE_MODULE_LEVEL >= TRACE_LEVEL_WARNING) && (TRACE_LEVEL_MAX >= TRACE_LEVEL_WARNING)
+#define TRACE_WARNING(id, ...) TRACE_ARGS_(id, __VA_ARGS__)
+#define TRACE_WARNING_DATA(id, p_data, len) TRACE_DATA_(id, p_data, len)
+#else
+#define TRACE_WARNING(id, ...) TRACE_NONE_()
+#define TRACE_WARNING_DATA(id, p_data, len) TRACE_NONE_()
+#endif
+
+#if (TRACE_MODULE_LEVEL >= TRACE_LEVEL_INFO) && (TRACE_LEVEL_MAX >= TRACE_LEVEL_INFO)
+#define TRACE_INFO(id, ...) TRACE_ARGS_(id, __VA_ARGS__)
+#define TRACE_INFO_DATA(id, p_data, len) TRACE_DATA_(id, p_data, len)
+#else
+#define TRACE_INFO(id, ...) TRACE_NONE_()
+#define TRACE_INFO_DATA(id, p_data, len) TRACE_NONE_()
+#endif
+
+#if (TRACE_MODULE_LEVEL >= TRACE_LEVEL_DEBUG) && (TRACE_LEVEL_MAX >= TRACE_LEVEL_DEBUG)
+#define TRACE_DEBUG(id, ...) TRACE_ARGS_(id, __VA_ARGS__)
+#define TRACE_DEBUG_DATA(id, p_data, len) TRACE_DATA_(id, p_data, len)
+#else
+#define TRACE_DEBUG(id, ...) TRACE_NONE_()
+#define TRACE_DEBUG_DATA(id, p_data, len) TRACE_NONE_()
+#endif
@@ -0,0 +1,20 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/**
+ * Trace record identifiers and their host side format, X(name, "format").
+ *
+ * Argument records carry 32-bit arguments consumed by the format. Data records (TRACE_*_DATA) carry raw bytes
+ * printed in hex after the format. IDs are assigned in order, append new entries at the end so recorded traces
+ * keep decoding. tools/trace_decode.py parses this list.
+ */
+#define TRACE_IDS(X)                                 \
+    X(DROPPED, "%d records dropped")                 \
+    X(BUS_WRITE, "Write addr: 0x%x, register: 0x%x") \
+    X(BUS_READ, "Read addr: 0x%x, register: 0x%x")   \
+    X(BUS_DATA, "Data")
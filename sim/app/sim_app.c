@@ -0,0 +1,52 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "sim_app.h"
+
+#include "app_scheduler.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "config.h"
+#include "lsm303agr.h"
+#include "lsm303agr_sim.h"
+#include "lsm303agr_twim.h"
+#include "nrfx_gpiote.h"
+#include "sim.h"
+
+#define SCHED_MAX_EVENT_DATA_SIZE 0 // As main.c.
+#define SCHED_QUEUE_SIZE 8          // As main.c.
+
+static const nrfx_twim_t m_twim = NRFX_TWIM_INSTANCE(TWIM_INST);
+
+bool sim_app_init(magnetometer_handler_t handler)
+{
+    nrfx_twim_config_t      twim_config = {.frequency = NRF_TWIM_FREQ_400K, .interrupt_priority = APP_IRQ_PRIORITY_HIGH};
+    nrfx_gpiote_in_config_t in_config   = NRFX_GPIOTE_CONFIG_IN_SENSE_TOGGLE(true);
+
+    APP_SCHED_INIT(SCHED_MAX_EVENT_DATA_SIZE, SCHED_QUEUE_SIZE);
+    APP_ERROR_CHECK(app_timer_init());
+
+    lsm303agr_sim_init(MAG_INT_PIN);
+
+    APP_ERROR_CHECK(nrfx_twim_init(&m_twim, &twim_config, lsm303agr_twim_event_handler, NULL));
+    nrfx_twim_enable(&m_twim);
+
+    APP_ERROR_CHECK(nrfx_gpiote_init());
+    APP_ERROR_CHECK(nrfx_gpiote_in_init(MAG_INT_PIN, &in_config, magnetometer_gpiote_event_handler));
+
+    return lsm303agr_init(lsm303agr_twim_bus(&m_twim)) && magnetometer_init() && magnetometer_register(handler, MAGNETOMETER_EVT_MASK_ALL);
+}
+
+void sim_app_run_ms(uint32_t time_ms)
+{
+    uint64_t end_us = sim_now_us() + (time_ms * 1000ULL);
+
+    while (sim_now_us() < end_us) {
+        app_sched_execute();
+        __WFE();
+    }
+    app_sched_execute();
+}
@@ -0,0 +1,31 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include "magnetometer.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Application harness of the host programs running magnetometer.c, it stands in for main.c on the target.
+ */
+
+/**@brief       Bring up the scheduler, app_timer, the simulated device, the bus, the pin and the detection logic as
+ *              main.c does on the target.
+ *
+ * @param[in]   handler   -   Magnetometer event handler, subscribed to all events.
+ *
+ * @retval  True if the device was found.
+ */
+bool sim_app_init(magnetometer_handler_t handler);
+
+/**@brief       Run the main loop of main.c for a time, the core sleeps until an interrupt.
+ *
+ * @param[in]   time_ms   -   Time to run, the loop ends at the first wake-up after it.
+ */
+void sim_app_run_ms(uint32_t time_ms);
@@ -0,0 +1,19 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "app_error.h"
+
+#include "sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+void app_error_handler(ret_code_t error_code, uint32_t line_num, const uint8_t *p_file_name)
+{
+    fprintf(stderr, "Fatal error 0x%x at %s:%u, %llu us.\n", error_code, (const char *)p_file_name, line_num,
+            (unsigned long long)sim_now_us());
+    exit(EXIT_FAILURE);
+}
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "app_scheduler.h"
+
+#include "app_util.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Queued event.
+typedef struct {
+    app_sched_event_handler_t handler;    // Handler.
+    uint16_t                  event_size; // Event data size.
+} sched_event_t;
+
+static sched_event_t *mp_events = NULL; // Event headers, one slot is kept free.
+static uint8_t       *mp_data   = NULL; // Event data, max_event_size per slot.
+static uint16_t       m_max_event_size;
+static uint16_t       m_slots;
+static uint16_t       m_head = 0; // Next event to run.
+static uint16_t       m_tail = 0; // Next free slot.
+
+uint32_t app_sched_init(uint16_t max_event_size, uint16_t queue_size, void *p_evt_buffer)
+{
+    m_slots          = queue_size + 1;
+    m_max_event_size = max_event_size;
+    m_head           = 0;
+    m_tail           = 0;
+
+    free(mp_events);
+    free(mp_data);
+    mp_events = calloc(m_slots, sizeof(*mp_events));
+    mp_data   = calloc(m_slots, MAX(max_event_size, 1));
+
+    return ((mp_events != NULL) && (mp_data != NULL)) ? NRF_SUCCESS : NRF_ERROR_NO_MEM;
+}
+
+uint16_t app_sched_queue_space_get(void) { return (uint16_t)((m_head + m_slots - m_tail - 1) % m_slots); }
+
+uint32_t app_sched_event_put(void const *p_event_data, uint16_t event_size, app_sched_event_handler_t handler)
+{
+    if (event_size > m_max_event_size) {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    // Interrupts only run at wait points, the queue is never entered twice.
+    if (app_sched_queue_space_get() == 0) {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    mp_events[m_tail].handler    = handler;
+    mp_events[m_tail].event_size = event_size;
+    if ((p_event_data != NULL) && (event_size > 0)) {
+        memcpy(&mp_data[m_tail * m_max_event_size], p_event_data, event_size);
+    }
+
+    m_tail = (m_tail + 1) % m_slots;
+
+    return NRF_SUCCESS;
+}
+
+void app_sched_execute(void)
+{
+    while (m_head != m_tail) {
+        sched_event_t event  = mp_events[m_head];
+        void         *p_data = (event.event_size > 0) ? &mp_data[m_head * m_max_event_size] : NULL;
+
+        event.handler(p_data, event.event_size);
+        m_head = (m_head + 1) % m_slots;
+    }
+}
@@ -0,0 +1,169 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "app_timer_sim.h"
+
+#include "app_timer.h"
+#include "sim.h"
+
+#include <stddef.h>
+
+#define TICK_HZ (APP_TIMER_CLOCK_FREQ / (APP_TIMER_CONFIG_RTC_FREQUENCY + 1)) // RTC1 counter frequency.
+
+static app_timer_t          *mp_timers = NULL; // Created timers, in creation order.
+static bool                  m_init    = false;
+static app_timer_sim_stats_t m_stats;
+
+static void rtc_irq_handler(void);
+
+static sim_irq_t m_rtc_irq = {
+    .handler  = rtc_irq_handler,
+    .priority = APP_TIMER_CONFIG_IRQ_PRIORITY,
+};
+
+/** Ticks elapsed since the simulation start. */
+static uint64_t now_ticks(void) { return (sim_now_us() * TICK_HZ) / 1000000; }
+
+/** Time the counter reaches the tick [us]. */
+static uint64_t tick_us(uint64_t tick) { return ((tick * 1000000) + TICK_HZ - 1) / TICK_HZ; }
+
+/** Active timer expiring first, creation order breaks a tie. */
+static app_timer_t *timer_next(void)
+{
+    app_timer_t *p_next = NULL;
+
+    for (app_timer_t *p_timer = mp_timers; p_timer != NULL; p_timer = p_timer->p_next) {
+        if (p_timer->active && ((p_next == NULL) || (p_timer->end_val < p_next->end_val))) {
+            p_next = p_timer;
+        }
+    }
+
+    return p_next;
+}
+
+static void rtc_irq_handler(void)
+{
+    uint64_t     now = now_ticks();
+    app_timer_t *p_timer;
+
+    // Handlers may stop and start timers, the next one is searched again after each.
+    while (((p_timer = timer_next()) != NULL) && (p_timer->end_val <= now)) {
+        if (p_timer->repeated) {
+            p_timer->end_val += p_timer->period;
+        } else {
+            p_timer->active = false;
+        }
+
+        m_stats.timeouts++;
+        p_timer->handler(p_timer->p_context);
+    }
+}
+
+static uint64_t rtc_next_us(void)
+{
+    // Expired timers wait for the interrupt, which may be masked by a running handler of the same priority.
+    if (m_rtc_irq.pending) {
+        return SIM_NEVER;
+    }
+
+    app_timer_t *p_timer = timer_next();
+
+    return (p_timer != NULL) ? tick_us(p_timer->end_val) : SIM_NEVER;
+}
+
+static void rtc_run(uint64_t now_us) { sim_irq_pend(&m_rtc_irq); }
+
+static const sim_source_t m_source = {
+    .next_us = rtc_next_us,
+    .run     = rtc_run,
+};
+
+ret_code_t app_timer_init(void)
+{
+    if (!m_init) {
+        sim_irq_register(&m_rtc_irq);
+        sim_source_register(&m_source);
+        m_init = true;
+    }
+
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_create(app_timer_id_t const *p_timer_id, app_timer_mode_t mode, app_timer_timeout_handler_t timeout_handler)
+{
+    app_timer_t *p_timer = *p_timer_id;
+
+    if (timeout_handler == NULL) {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    if (p_timer->active) {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    // A timer created again keeps its place in the list.
+    if (p_timer->handler == NULL) {
+        app_timer_t **pp_tail = &mp_timers;
+
+        while (*pp_tail != NULL) {
+            pp_tail = &(*pp_tail)->p_next;
+        }
+
+        p_timer->p_next = NULL;
+        *pp_tail        = p_timer;
+    }
+
+    p_timer->handler  = timeout_handler;
+    p_timer->repeated = (mode == APP_TIMER_MODE_REPEATED);
+
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void *p_context)
+{
+    if (timer_id->handler == NULL) {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    if ((timeout_ticks < APP_TIMER_MIN_TIMEOUT_TICKS) || (timeout_ticks > APP_TIMER_MAX_CNT_VAL)) {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    if (timer_id->active) {
+        return NRF_SUCCESS;
+    }
+
+    timer_id->p_context = p_context;
+    timer_id->end_val   = now_ticks() + timeout_ticks;
+    timer_id->period    = timeout_ticks;
+    timer_id->active    = true;
+
+    m_stats.starts++;
+
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_stop(app_timer_id_t timer_id)
+{
+    timer_id->active = false;
+
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_stop_all(void)
+{
+    for (app_timer_t *p_timer = mp_timers; p_timer != NULL; p_timer = p_timer->p_next) {
+        p_timer->active = false;
+    }
+
+    return NRF_SUCCESS;
+}
+
+uint32_t app_timer_cnt_get(void) { return (uint32_t)(now_ticks() & APP_TIMER_MAX_CNT_VAL); }
+
+uint32_t app_timer_cnt_diff_compute(uint32_t ticks_to, uint32_t ticks_from) { return (ticks_to - ticks_from) & APP_TIMER_MAX_CNT_VAL; }
+
+void app_timer_sim_stats_get(app_timer_sim_stats_t *p_stats) { *p_stats = m_stats; }
@@ -0,0 +1,18 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// app_timer statistics.
+typedef struct {
+    uint32_t starts;   // Timers started.
+    uint32_t timeouts; // Timeout handlers run.
+} app_timer_sim_stats_t;
+
+/** app_timer statistics. */
+void app_timer_sim_stats_get(app_timer_sim_stats_t *p_stats);
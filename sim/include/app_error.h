@@ -0,0 +1,37 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** Host simulation stand-in of the SDK error checks, a failure stops the simulation. */
+
+#include "nrf_assert.h"
+#include "sdk_errors.h"
+
+#include <stdbool.h>
+
+/**@brief       Report a failed check and exit.
+ *
+ * @param[in]   error_code  -   Error code.
+ * @param[in]   line_num    -   Line of the check.
+ * @param[in]   p_file_name -   File of the check.
+ */
+void app_error_handler(ret_code_t error_code, uint32_t line_num, const uint8_t *p_file_name) __attribute__((noreturn));
+
+#define APP_ERROR_CHECK(ERR_CODE)                                                                                                     \
+    do {                                                                                                                              \
+        const uint32_t LOCAL_ERR_CODE = (uint32_t)(ERR_CODE);                                                                         \
+        if (LOCAL_ERR_CODE != NRF_SUCCESS) {                                                                                          \
+            app_error_handler(LOCAL_ERR_CODE, __LINE__, (const uint8_t *)__FILE__);                                                   \
+        }                                                                                                                             \
+    } while (0)
+
+#define APP_ERROR_CHECK_BOOL(BOOLEAN_VALUE)                                                                                           \
+    do {                                                                                                                              \
+        if (!(BOOLEAN_VALUE)) {                                                                                                       \
+            app_error_handler(0, __LINE__, (const uint8_t *)__FILE__);                                                                \
+        }                                                                                                                             \
+    } while (0)
@@ -0,0 +1,44 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** Host simulation stand-in of the app_scheduler, a FIFO of handlers run from the main loop. */
+
+#include "app_error.h"
+#include "app_util_platform.h"
+
+#include <stdint.h>
+
+typedef void (*app_sched_event_handler_t)(void *p_event_data, uint16_t event_size);
+
+/**@brief       Initialize the scheduler queue.
+ *
+ * @param[in]   max_event_size  -   Maximum event data size.
+ * @param[in]   queue_size      -   Number of events the queue holds.
+ * @param[in]   p_evt_buffer    -   Unused, the queue is allocated on the host heap.
+ */
+uint32_t app_sched_init(uint16_t max_event_size, uint16_t queue_size, void *p_evt_buffer);
+
+#define APP_SCHED_INIT(EVENT_SIZE, QUEUE_SIZE)                                                                                        \
+    do {                                                                                                                              \
+        uint32_t ERR_CODE = app_sched_init((EVENT_SIZE), (QUEUE_SIZE), NULL);                                                         \
+        APP_ERROR_CHECK(ERR_CODE);                                                                                                    \
+    } while (0)
+
+/** Run the queued handlers, called from the main loop. */
+void app_sched_execute(void);
+
+/**@brief       Queue a handler, may be called from any priority.
+ *
+ * @param[in]   p_event_data    -   Event data copied into the queue, may be NULL.
+ * @param[in]   event_size      -   Event data size.
+ * @param[in]   handler         -   Handler.
+ */
+uint32_t app_sched_event_put(void const *p_event_data, uint16_t event_size, app_sched_event_handler_t handler);
+
+/** Free space in the queue. */
+uint16_t app_sched_queue_space_get(void);
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/**
+ * Host simulation stand-in of app_timer.
+ *
+ * Timers expire on RTC1 ticks derived from the virtual time and their handlers run from the RTC1 interrupt at
+ * APP_TIMER_CONFIG_IRQ_PRIORITY, the prescaler and the priority come from the sdk_config.h of the firmware. Time
+ * jumps straight to the next expiry, so timeouts cost no wall-clock time.
+ */
+
+#include "app_util.h"
+#include "sdk_config.h"
+#include "sdk_errors.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define APP_TIMER_CLOCK_FREQ 32768
+#define APP_TIMER_MIN_TIMEOUT_TICKS 5
+#define APP_TIMER_MAX_CNT_VAL 0x00FFFFFF
+
+/** Convert milliseconds to timer ticks. */
+#define APP_TIMER_TICKS(MS) ((uint32_t)ROUNDED_DIV((MS) * (uint64_t)APP_TIMER_CLOCK_FREQ, 1000 * (APP_TIMER_CONFIG_RTC_FREQUENCY + 1)))
+
+typedef void (*app_timer_timeout_handler_t)(void *p_context);
+
+typedef enum {
+    APP_TIMER_MODE_SINGLE_SHOT, // The timer will expire only once.
+    APP_TIMER_MODE_REPEATED,    // The timer will restart each time it expires.
+} app_timer_mode_t;
+
+typedef struct app_timer_s {
+    app_timer_timeout_handler_t handler;   // Timeout handler.
+    void                       *p_context; // Context passed to the handler.
+    uint64_t                    end_val;   // Expiry, ticks since the simulation start.
+    uint32_t                    period;    // Repeat period in ticks, 0 for a single shot timer.
+    bool                        repeated;  // Created in repeated mode.
+    bool                        active;    // Running.
+    struct app_timer_s         *p_next;    // Next created timer.
+} app_timer_t;
+
+typedef app_timer_t *app_timer_id_t;
+
+#define APP_TIMER_DEF(timer_id)                  \
+    static app_timer_t          timer_id##_data = {0}; \
+    static const app_timer_id_t timer_id        = &timer_id##_data
+
+/** Start RTC1, the counter starts from the current virtual time. */
+ret_code_t app_timer_init(void);
+
+/**@brief       Create a timer.
+ *
+ * @param[in]   p_timer_id      -   Timer created with APP_TIMER_DEF().
+ * @param[in]   mode            -   Single shot or repeated.
+ * @param[in]   timeout_handler -   Handler called from the RTC1 interrupt.
+ */
+ret_code_t app_timer_create(app_timer_id_t const *p_timer_id, app_timer_mode_t mode, app_timer_timeout_handler_t timeout_handler);
+
+/**@brief       Start a timer, a running timer is left unchanged as with app_timer2.
+ *
+ * @param[in]   timer_id        -   Timer.
+ * @param[in]   timeout_ticks   -   Ticks to the expiry, the repeat period of a repeated timer.
+ * @param[in]   p_context       -   Context passed to the handler.
+ */
+ret_code_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void *p_context);
+
+ret_code_t app_timer_stop(app_timer_id_t timer_id);
+ret_code_t app_timer_stop_all(void);
+
+/** Current RTC counter value, 24 bits. */
+uint32_t app_timer_cnt_get(void);
+
+/** Ticks elapsed from ticks_from to ticks_to, modulo the counter width. */
+uint32_t app_timer_cnt_diff_compute(uint32_t ticks_to, uint32_t ticks_from);
@@ -0,0 +1,35 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** Host simulation stand-in of the SDK utility macros used by the drivers. */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+
+#ifndef MAX
+#define MAX(a, b) ((a) < (b) ? (b) : (a))
+#endif
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+#define STATIC_ASSERT(EXPR) _Static_assert(EXPR, #EXPR)
+
+#define ROUNDED_DIV(A, B) (((A) + ((B) / 2)) / (B))
+#define CEIL_DIV(A, B) (((A) + (B)-1) / (B))
+#define IS_POWER_OF_TWO(A) (((A) != 0) && ((((A)-1) & (A)) == 0))
+
+#define UNUSED_VARIABLE(X) ((void)(X))
+#define UNUSED_PARAMETER(X) UNUSED_VARIABLE(X)
+#define UNUSED_RETURN_VALUE(X) UNUSED_VARIABLE(X)
+
+#define STRINGIFY_(val) #val
+#define STRINGIFY(val) STRINGIFY_(val)
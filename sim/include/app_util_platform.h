@@ -0,0 +1,26 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/**
+ * Host simulation stand-in of the SDK platform macros.
+ *
+ * Simulated interrupts only run at wait points, never inside a critical region, so the region is a plain block.
+ */
+
+#include "app_util.h"
+#include "nrf.h"
+
+#define APP_IRQ_PRIORITY_HIGHEST 0
+#define APP_IRQ_PRIORITY_HIGH 2
+#define APP_IRQ_PRIORITY_MID 4
+#define APP_IRQ_PRIORITY_LOW 6
+#define APP_IRQ_PRIORITY_LOWEST 7
+#define APP_IRQ_PRIORITY_THREAD 15
+
+#define CRITICAL_REGION_ENTER() {
+#define CRITICAL_REGION_EXIT() }
@@ -0,0 +1,9 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** Host simulation stand-in of the board definitions, config.h only needs the include to resolve. */
@@ -0,0 +1,15 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** Host simulation stand-in of the CMSIS core intrinsics, waiting for an event advances virtual time. */
+
+#include "sim.h"
+
+#define __WFE() sim_wfe()
+#define __SEV()
+#define __DMB() __sync_synchronize()
@@ -0,0 +1,13 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** Host simulation stand-in of the SDK assert, aborts on failure. */
+
+#include <assert.h>
+
+#define ASSERT(expr) assert(expr)
@@ -0,0 +1,15 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** Host simulation stand-in of the busy wait delays, events and interrupts run meanwhile. */
+
+#include "sim.h"
+
+static inline void nrf_delay_us(uint32_t us_time) { sim_delay_us(us_time); }
+
+static inline void nrf_delay_ms(uint32_t ms_time) { sim_delay_us((uint64_t)ms_time * 1000); }
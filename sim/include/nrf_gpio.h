@@ -0,0 +1,27 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** Host simulation stand-in of the GPIO HAL, input levels are driven by the simulated devices. */
+
+#include <stdint.h>
+
+typedef enum {
+    NRF_GPIO_PIN_NOPULL   = 0, // Pin pull-up resistor disabled.
+    NRF_GPIO_PIN_PULLDOWN = 1, // Pin pull-down resistor enabled.
+    NRF_GPIO_PIN_PULLUP   = 3, // Pin pull-up resistor enabled.
+} nrf_gpio_pin_pull_t;
+
+/** Number of simulated pins. */
+#define SIM_GPIO_PIN_COUNT 48
+
+/** Input level of the pin. */
+uint32_t nrf_gpio_pin_read(uint32_t pin_number);
+
+void nrf_gpio_cfg_output(uint32_t pin_number);
+void nrf_gpio_pin_set(uint32_t pin_number);
+void nrf_gpio_pin_clear(uint32_t pin_number);
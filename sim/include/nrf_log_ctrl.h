@@ -0,0 +1,15 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** Host simulation stand-in of the log control, messages are printed immediately. */
+
+#include <stdbool.h>
+
+#define NRF_LOG_INIT(timestamp_func) 0
+#define NRF_LOG_PROCESS() false
+#define NRF_LOG_FLUSH()
@@ -0,0 +1,39 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** Host simulation stand-in of the nrfx definitions used by the drivers. */
+
+#include "nrf.h"
+#include "sdk_errors.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// nrfx error codes are the SDK error codes, as the nrfx glue of the nRF5 SDK defines them.
+typedef enum {
+    NRFX_SUCCESS                   = NRF_SUCCESS,
+    NRFX_ERROR_INTERNAL            = NRF_ERROR_INTERNAL,
+    NRFX_ERROR_NO_MEM              = NRF_ERROR_NO_MEM,
+    NRFX_ERROR_NOT_SUPPORTED       = NRF_ERROR_NOT_SUPPORTED,
+    NRFX_ERROR_INVALID_PARAM       = NRF_ERROR_INVALID_PARAM,
+    NRFX_ERROR_INVALID_STATE       = NRF_ERROR_INVALID_STATE,
+    NRFX_ERROR_INVALID_LENGTH      = NRF_ERROR_INVALID_LENGTH,
+    NRFX_ERROR_TIMEOUT             = NRF_ERROR_TIMEOUT,
+    NRFX_ERROR_FORBIDDEN           = NRF_ERROR_FORBIDDEN,
+    NRFX_ERROR_NULL                = NRF_ERROR_NULL,
+    NRFX_ERROR_INVALID_ADDR        = NRF_ERROR_INVALID_ADDR,
+    NRFX_ERROR_BUSY                = NRF_ERROR_BUSY,
+    NRFX_ERROR_ALREADY_INITIALIZED = NRF_ERROR_MODULE_ALREADY_INITIALIZED,
+
+    NRFX_ERROR_DRV_TWI_ERR_OVERRUN = NRF_ERROR_DRV_TWI_ERR_OVERRUN,
+    NRFX_ERROR_DRV_TWI_ERR_ANACK   = NRF_ERROR_DRV_TWI_ERR_ANACK,
+    NRFX_ERROR_DRV_TWI_ERR_DNACK   = NRF_ERROR_DRV_TWI_ERR_DNACK,
+} nrfx_err_t;
+
+#define NRFX_ASSERT(expression)
@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** Host simulation stand-in of the nrfx GPIOTE driver, IN events only. */
+
+#include "nrf_gpio.h"
+#include "nrfx.h"
+
+typedef uint32_t nrfx_gpiote_pin_t;
+
+typedef enum {
+    NRF_GPIOTE_POLARITY_LOTOHI = 1, // Low to high.
+    NRF_GPIOTE_POLARITY_HITOLO = 2, // High to low.
+    NRF_GPIOTE_POLARITY_TOGGLE = 3, // Toggle.
+} nrf_gpiote_polarity_t;
+
+typedef struct {
+    nrf_gpiote_polarity_t sense;           // Transition that triggers the interrupt.
+    nrf_gpio_pin_pull_t   pull;            // Pulling mode.
+    bool                  is_watcher;      // True when the input pin is tracking an output pin.
+    bool                  hi_accuracy;     // True when high accuracy (IN_EVENT) is used.
+    bool                  skip_gpio_setup; // Do not change GPIO configuration.
+} nrfx_gpiote_in_config_t;
+
+#define NRFX_GPIOTE_CONFIG_IN_SENSE_LOTOHI(hi_accu) {.sense = NRF_GPIOTE_POLARITY_LOTOHI, .pull = NRF_GPIO_PIN_NOPULL, .hi_accuracy = hi_accu}
+#define NRFX_GPIOTE_CONFIG_IN_SENSE_HITOLO(hi_accu) {.sense = NRF_GPIOTE_POLARITY_HITOLO, .pull = NRF_GPIO_PIN_NOPULL, .hi_accuracy = hi_accu}
+#define NRFX_GPIOTE_CONFIG_IN_SENSE_TOGGLE(hi_accu) {.sense = NRF_GPIOTE_POLARITY_TOGGLE, .pull = NRF_GPIO_PIN_NOPULL, .hi_accuracy = hi_accu}
+
+typedef void (*nrfx_gpiote_evt_handler_t)(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action);
+
+nrfx_err_t nrfx_gpiote_init(void);
+bool       nrfx_gpiote_is_init(void);
+
+/**@brief       Configure a pin as a GPIOTE input, the event stays disabled until nrfx_gpiote_in_event_enable().
+ *
+ * @param[in]   pin           -   Pin.
+ * @param[in]   p_config      -   Configuration.
+ * @param[in]   evt_handler   -   Handler called from the GPIOTE interrupt, may be NULL.
+ */
+nrfx_err_t nrfx_gpiote_in_init(nrfx_gpiote_pin_t pin, nrfx_gpiote_in_config_t const *p_config, nrfx_gpiote_evt_handler_t evt_handler);
+
+void     nrfx_gpiote_in_uninit(nrfx_gpiote_pin_t pin);
+void     nrfx_gpiote_in_event_enable(nrfx_gpiote_pin_t pin, bool int_enable);
+void     nrfx_gpiote_in_event_disable(nrfx_gpiote_pin_t pin);
+bool     nrfx_gpiote_in_is_set(nrfx_gpiote_pin_t pin);
+uint32_t nrfx_gpiote_in_event_addr_get(nrfx_gpiote_pin_t pin);
@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/**
+ * Host simulation stand-in of the nrfx log macros.
+ *
+ * Messages are printed to stderr with the virtual time and the module name, SIM_LOG_LEVEL selects the most verbose
+ * level printed (1 error, 2 warning, 3 info, 4 debug).
+ */
+
+#include "app_util.h"
+
+#include <stdint.h>
+
+#ifndef SIM_LOG_LEVEL
+#define SIM_LOG_LEVEL 2
+#endif
+
+/**@brief       Print a log message.
+ *
+ * @param[in]   p_module  -   Module name.
+ * @param[in]   p_level   -   Level name.
+ * @param[in]   p_format  -   printf format.
+ */
+void sim_log(const char *p_module, const char *p_level, const char *p_format, ...) __attribute__((format(printf, 3, 4)));
+
+/** Print a buffer in hexadecimal. */
+void sim_log_hexdump(const char *p_module, const void *p_data, uint32_t len);
+
+#ifdef NRF_LOG_MODULE_NAME
+#define SIM_LOG_MODULE STRINGIFY(NRF_LOG_MODULE_NAME)
+#else
+#define SIM_LOG_MODULE "app"
+#endif
+
+#define SIM_LOG(level, name, ...)                          \
+    do {                                                   \
+        if ((level) <= SIM_LOG_LEVEL) {                    \
+            sim_log(SIM_LOG_MODULE, name, __VA_ARGS__);    \
+        }                                                  \
+    } while (0)
+
+#define NRF_LOG_MODULE_REGISTER() extern int sim_log_module_registered
+
+#define NRF_LOG_ERROR(...) SIM_LOG(1, "error", __VA_ARGS__)
+#define NRF_LOG_WARNING(...) SIM_LOG(2, "warning", __VA_ARGS__)
+#define NRF_LOG_INFO(...) SIM_LOG(3, "info", __VA_ARGS__)
+#define NRF_LOG_DEBUG(...) SIM_LOG(4, "debug", __VA_ARGS__)
+
+#define NRFX_LOG_ERROR NRF_LOG_ERROR
+#define NRFX_LOG_WARNING NRF_LOG_WARNING
+#define NRFX_LOG_INFO NRF_LOG_INFO
+#define NRFX_LOG_DEBUG NRF_LOG_DEBUG
+
+#define NRFX_LOG_HEXDUMP_INFO(p_memory, length)                     \
+    do {                                                            \
+        if (3 <= SIM_LOG_LEVEL) {                                   \
+            sim_log_hexdump(SIM_LOG_MODULE, (p_memory), (length));  \
+        }                                                           \
+    } while (0)
@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** Host simulation stand-in of the nrfx SPIM driver, transfers are served by the device whose chip select is low. */
+
+#include "nrfx.h"
+
+// SPIM peripheral, a bus of the simulation.
+typedef struct {
+    uint8_t index; // Bus index.
+} NRF_SPIM_Type;
+
+typedef struct {
+    NRF_SPIM_Type *p_reg;        // Peripheral.
+    uint8_t        drv_inst_idx; // Driver instance index.
+} nrfx_spim_t;
+
+// Instance number is expanded first, it may be given by a macro as in the SDK.
+#define SIM_SPIM_CONCAT(a, b) a##b
+#define NRFX_SPIM_INSTANCE(id)                                     \
+    {                                                              \
+        .p_reg = &SIM_SPIM_CONCAT(sim_spim, id), .drv_inst_idx = id \
+    }
+
+extern NRF_SPIM_Type sim_spim2;
+
+#define NRFX_SPIM_PIN_NOT_USED 0xFF
+
+// SCK frequency.
+typedef enum {
+    NRF_SPIM_FREQ_1M = 0x10000000,
+    NRF_SPIM_FREQ_2M = 0x20000000,
+    NRF_SPIM_FREQ_4M = 0x40000000,
+    NRF_SPIM_FREQ_8M = 0x80000000,
+} nrf_spim_frequency_t;
+
+typedef enum {
+    NRF_SPIM_MODE_0, // SCK active high, sample on leading edge of clock.
+    NRF_SPIM_MODE_1, // SCK active high, sample on trailing edge of clock.
+    NRF_SPIM_MODE_2, // SCK active low, sample on leading edge of clock.
+    NRF_SPIM_MODE_3, // SCK active low, sample on trailing edge of clock.
+} nrf_spim_mode_t;
+
+typedef struct {
+    uint8_t const *p_tx_buffer; // Pointer to TX buffer.
+    size_t         tx_length;   // TX buffer length.
+    uint8_t       *p_rx_buffer; // Pointer to RX buffer.
+    size_t         rx_length;   // RX buffer length.
+} nrfx_spim_xfer_desc_t;
+
+#define NRFX_SPIM_XFER_TRX(_p_tx, _tx_length, _p_rx, _rx_length)                                                                 \
+    {                                                                                                                             \
+        .p_tx_buffer = (uint8_t const *)(_p_tx), .tx_length = (_tx_length), .p_rx_buffer = (_p_rx), .rx_length = (_rx_length)    \
+    }
+
+#define NRFX_SPIM_XFER_TX(p_buf, length) NRFX_SPIM_XFER_TRX(p_buf, length, NULL, 0)
+#define NRFX_SPIM_XFER_RX(p_buf, length) NRFX_SPIM_XFER_TRX(NULL, 0, p_buf, length)
+
+typedef enum {
+    NRFX_SPIM_EVENT_DONE, // Transfer done.
+} nrfx_spim_evt_type_t;
+
+typedef struct {
+    nrfx_spim_evt_type_t  type;      // Event type.
+    nrfx_spim_xfer_desc_t xfer_desc; // Transfer details.
+} nrfx_spim_evt_t;
+
+typedef void (*nrfx_spim_evt_handler_t)(nrfx_spim_evt_t const *p_event, void *p_context);
+
+typedef struct {
+    uint8_t              sck_pin;      // SCK pin number.
+    uint8_t              mosi_pin;     // MOSI pin number.
+    uint8_t              miso_pin;     // MISO pin number.
+    uint8_t              ss_pin;       // Slave Select pin number.
+    uint8_t              irq_priority; // Interrupt priority.
+    uint8_t              orc;          // Over-run character.
+    nrf_spim_frequency_t frequency;    // SPIM frequency.
+    nrf_spim_mode_t      mode;         // SPIM mode.
+} nrfx_spim_config_t;
+
+/**@brief       Initialize the SPIM driver instance, only the non-blocking mode with an event handler is simulated.
+ *
+ * @param[in]   p_instance    -   Driver instance.
+ * @param[in]   p_config      -   Configuration.
+ * @param[in]   handler       -   Event handler.
+ * @param[in]   p_context     -   Context passed to the event handler.
+ */
+nrfx_err_t nrfx_spim_init(nrfx_spim_t const *p_instance, nrfx_spim_config_t const *p_config, nrfx_spim_evt_handler_t handler,
+                          void *p_context);
+
+void nrfx_spim_uninit(nrfx_spim_t const *p_instance);
+
+/**@brief       Start a transfer, the event handler is called from the SPIM interrupt once the bus time elapsed.
+ *
+ * @param[in]   p_instance    -   Driver instance.
+ * @param[in]   p_xfer_desc   -   Transfer descriptor.
+ * @param[in]   flags         -   Transfer options, none are simulated.
+ */
+nrfx_err_t nrfx_spim_xfer(nrfx_spim_t const *p_instance, nrfx_spim_xfer_desc_t const *p_xfer_desc, uint32_t flags);
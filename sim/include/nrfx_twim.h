@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+/** Host simulation stand-in of the nrfx TWIM driver, transfers are served by the simulated devices on the bus. */
+
+#include "nrfx.h"
+
+// TWIM peripheral, a bus of the simulation.
+typedef struct {
+    uint8_t index; // Bus index.
+} NRF_TWIM_Type;
+
+typedef struct {
+    NRF_TWIM_Type *p_twim;       // Peripheral.
+    uint8_t        drv_inst_idx; // Driver instance index.
+} nrfx_twim_t;
+
+// Instance number is expanded first, it may be given by a macro as in the SDK.
+#define SIM_TWIM_CONCAT(a, b) a##b
+#define NRFX_TWIM_INSTANCE(id)                                      \
+    {                                                               \
+        .p_twim = &SIM_TWIM_CONCAT(sim_twim, id), .drv_inst_idx = id \
+    }
+
+extern NRF_TWIM_Type sim_twim0;
+extern NRF_TWIM_Type sim_twim1;
+
+// SCL frequency.
+typedef enum {
+    NRF_TWIM_FREQ_100K = 0x01980000,
+    NRF_TWIM_FREQ_250K = 0x04000000,
+    NRF_TWIM_FREQ_400K = 0x06400000,
+} nrf_twim_frequency_t;
+
+typedef enum {
+    NRFX_TWIM_EVT_DONE,         // Transfer completed event.
+    NRFX_TWIM_EVT_ADDRESS_NACK, // Error event: NACK received after sending the address.
+    NRFX_TWIM_EVT_DATA_NACK,    // Error event: NACK received after sending a data byte.
+    NRFX_TWIM_EVT_OVERRUN,      // Error event: The unread data is replaced by new data.
+    NRFX_TWIM_EVT_BUS_ERROR,    // Error event: An unexpected transition occurred on the bus.
+} nrfx_twim_evt_type_t;
+
+typedef enum {
+    NRFX_TWIM_XFER_TX,   // TX transfer.
+    NRFX_TWIM_XFER_RX,   // RX transfer.
+    NRFX_TWIM_XFER_TXRX, // TX transfer followed by RX transfer with repeated start.
+    NRFX_TWIM_XFER_TXTX, // TX transfer followed by TX transfer with repeated start.
+} nrfx_twim_xfer_type_t;
+
+typedef struct {
+    nrfx_twim_xfer_type_t type;             // Type of transfer.
+    uint8_t               address;          // Slave address.
+    size_t                primary_length;   // Number of bytes transferred.
+    size_t                secondary_length; // Number of bytes transferred.
+    uint8_t              *p_primary_buf;    // Pointer to transferred data.
+    uint8_t              *p_secondary_buf;  // Pointer to transferred data.
+} nrfx_twim_xfer_desc_t;
+
+#define NRFX_TWIM_XFER_DESC(_type, _addr, _p_primary, _primary_length, _p_secondary, _secondary_length)                          \
+    {                                                                                                                             \
+        .type = (_type), .address = (_addr), .primary_length = (_primary_length), .secondary_length = (_secondary_length),        \
+        .p_primary_buf = (_p_primary), .p_secondary_buf = (_p_secondary)                                                          \
+    }
+
+#define NRFX_TWIM_XFER_DESC_TX(addr, p_data, length) NRFX_TWIM_XFER_DESC(NRFX_TWIM_XFER_TX, addr, p_data, length, NULL, 0)
+#define NRFX_TWIM_XFER_DESC_RX(addr, p_data, length) NRFX_TWIM_XFER_DESC(NRFX_TWIM_XFER_RX, addr, p_data, length, NULL, 0)
+#define NRFX_TWIM_XFER_DESC_TXRX(addr, p_tx, tx_len, p_rx, rx_len)                                                               \
+    NRFX_TWIM_XFER_DESC(NRFX_TWIM_XFER_TXRX, addr, p_tx, tx_len, p_rx, rx_len)
+
+typedef struct {
+    nrfx_twim_evt_type_t  type;      // Event type.
+    nrfx_twim_xfer_desc_t xfer_desc; // Transfer details.
+} nrfx_twim_evt_t;
+
+typedef void (*nrfx_twim_evt_handler_t)(nrfx_twim_evt_t const *p_event, void *p_context);
+
+typedef struct {
+    uint32_t             scl;                // SCL pin number.
+    uint32_t             sda;                // SDA pin number.
+    nrf_twim_frequency_t frequency;          // TWIM frequency.
+    uint8_t              interrupt_priority; // Interrupt priority.
+    bool                 hold_bus_uninit;    // Hold pull up state on GPIO pins after uninit.
+} nrfx_twim_config_t;
+
+/**@brief       Initialize the TWIM driver instance, only the non-blocking mode with an event handler is simulated.
+ *
+ * @param[in]   p_instance    -   Driver instance.
+ * @param[in]   p_config      -   Configuration.
+ * @param[in]   event_handler -   Event handler.
+ * @param[in]   p_context     -   Context passed to the event handler.
+ */
+nrfx_err_t nrfx_twim_init(nrfx_twim_t const *p_instance, nrfx_twim_config_t const *p_config, nrfx_twim_evt_handler_t event_handler,
+                          void *p_context);
+
+void nrfx_twim_uninit(nrfx_twim_t const *p_instance);
+void nrfx_twim_enable(nrfx_twim_t const *p_instance);
+void nrfx_twim_disable(nrfx_twim_t const *p_instance);
+
+/**@brief       Start a transfer, the event handler is called from the TWIM interrupt once the bus time elapsed.
+ *
+ * @param[in]   p_instance    -   Driver instance.
+ * @param[in]   p_xfer_desc   -   Transfer descriptor.
+ * @param[in]   flags         -   Transfer options, none are simulated.
+ */
+nrfx_err_t nrfx_twim_xfer(nrfx_twim_t const *p_instance, nrfx_twim_xfer_desc_t const *p_xfer_desc, uint32_t flags);
+
+bool nrfx_twim_is_busy(nrfx_twim_t const *p_instance);
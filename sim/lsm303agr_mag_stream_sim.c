@@ -0,0 +1,15 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "lsm303agr_mag_stream.h"
+
+// PPI triggered acquisition needs the TIMER and PPI peripherals, which are not simulated.
+
+bool lsm303agr_mag_stream_start(uint32_t drdy_event_addr, uint32_t drdy_pin, lsm303agr_mag_stream_handler_t handler) { return false; }
+
+void lsm303agr_mag_stream_stop(void) {}
+
+bool lsm303agr_mag_stream_is_running(void) { return false; }
@@ -0,0 +1,451 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "lsm303agr_sim.h"
+
+#include "lsm303agr_types.h"
+#include "nrf_gpio_sim.h"
+#include "sim.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define CFG_A_MD_MASK 0x03        // Mode select.
+#define CFG_A_ODR_POS 2           // Output data rate.
+#define CFG_A_SOFT_RST (1 << 5)   // Configuration and user registers reset, self clearing.
+#define CFG_A_REBOOT (1 << 6)     // Memory content reboot, self clearing.
+#define CFG_A_RESET 0x03          // Idle mode.
+#define CFG_B_INT_ON_DATAOFF 0x08 // Comparator checks data after the hard-iron correction.
+#define CFG_C_INT_MAG 0x01        // DRDY driven on the pin.
+#define CFG_C_BLE 0x08            // Output high byte first.
+#define CFG_C_I2C_DIS 0x20        // I2C interface inhibited.
+#define CFG_C_INT_MAG_PIN 0x40    // INT driven on the pin.
+#define INT_CTRL_IEN 0x01         // Interrupt enabled.
+#define INT_CTRL_IEL 0x02         // Interrupt latched.
+#define INT_CTRL_IEA 0x04         // Interrupt active high.
+#define INT_CTRL_RESET 0xE0       // All axes enabled, interrupt disabled.
+#define INT_SOURCE_INT 0x01       // Interrupt event.
+#define INT_SOURCE_MROI 0x02      // Measurement range overflow.
+#define STATUS_DA_MASK 0x07       // Xda, Yda and Zda.
+#define STATUS_ZYXDA 0x08         // All axes available.
+#define STATUS_OR_MASK 0x70       // Xor, Yor and Zor.
+#define STATUS_ZYXOR 0x80         // All axes overrun.
+
+#define REG_COUNT 0x80
+#define SPI_ADDR_MASK 0x7F // Register address AD(6:0) of the SPI command byte.
+
+static uint8_t  m_reg[REG_COUNT]; // Register file.
+static uint8_t  m_pointer;        // Register address of the next access.
+static uint32_t m_int_pin;        // Pin connected to INT_MAG/DRDY.
+static bool     m_int_active;     // Comparator INT state, before the polarity.
+
+static int16_t  m_field[3];             // Applied field [LSB].
+static uint64_t m_next_sample_us;       // Next measurement, SIM_NEVER in idle mode.
+static uint64_t m_sample_period_us;     // Measurement period of continuous mode.
+static bool     m_single;               // The pending measurement is a single measurement.
+
+static lsm303agr_sim_point_t m_script[LSM303AGR_SIM_SCRIPT_SIZE];
+static uint32_t              m_script_count = 0;
+static uint32_t              m_script_index = 0; // Next point to apply.
+
+static lsm303agr_sim_stats_t m_stats;
+
+static const uint32_t m_odr_hz[] = {10, 20, 50, 100};
+
+static bool reg_is_writable(uint8_t reg)
+{
+    return ((reg >= LSM303AGR_OFFSET_X_REG_L_M) && (reg <= LSM303AGR_OFFSET_Z_REG_H_M)) ||
+           ((reg >= LSM303AGR_CFG_REG_A_M) && (reg <= LSM303AGR_INT_CTRL_REG_M)) || (reg == LSM303AGR_INT_THS_L_REG_M) ||
+           (reg == LSM303AGR_INT_THS_H_REG_M);
+}
+
+static int16_t reg_get_s16(uint8_t reg_l) { return (int16_t)((m_reg[reg_l + 1] << 8) | m_reg[reg_l]); }
+
+/** Drive the INT_MAG/DRDY pin from the DRDY and INT states. */
+static void pin_update(void)
+{
+    uint8_t cfg_c    = m_reg[LSM303AGR_CFG_REG_C_M];
+    uint8_t int_ctrl = m_reg[LSM303AGR_INT_CTRL_REG_M];
+    bool    level    = false;
+
+    // INT_MAG/DRDY is a single pin, the interrupt takes it over from DRDY.
+    if (cfg_c & CFG_C_INT_MAG_PIN) {
+        bool active_high = (int_ctrl & INT_CTRL_IEA) != 0;
+
+        level = (int_ctrl & INT_CTRL_IEN) && (m_int_active == active_high);
+    } else if (cfg_c & CFG_C_INT_MAG) {
+        level = (m_reg[LSM303AGR_STATUS_REG_M] & STATUS_ZYXDA) != 0;
+    }
+
+    sim_gpio_input_set(m_int_pin, level);
+}
+
+/** Schedule the next measurement after a CFG_REG_A_M write. */
+static void mode_update(void)
+{
+    uint8_t cfg_a = m_reg[LSM303AGR_CFG_REG_A_M];
+
+    m_sample_period_us = 1000000 / m_odr_hz[(cfg_a >> CFG_A_ODR_POS) & 0x03];
+
+    switch (cfg_a & CFG_A_MD_MASK) {
+    case LSM303AGR_MODE_CONTINUOUS:
+        m_single         = false;
+        m_next_sample_us = sim_now_us() + m_sample_period_us;
+        break;
+
+    case LSM303AGR_MODE_SINGLE:
+        m_single         = true;
+        m_next_sample_us = sim_now_us() + LSM303AGR_SIM_SINGLE_US;
+        break;
+
+    default:
+        m_single         = false;
+        m_next_sample_us = SIM_NEVER;
+        break;
+    }
+}
+
+/** Configuration and user registers reset, the output and status registers are cleared. */
+static void soft_reset(void)
+{
+    memset(m_reg, 0, sizeof(m_reg));
+    m_reg[LSM303AGR_WHO_AM_I_M]     = LSM303AGR_ID_MG;
+    m_reg[LSM303AGR_CFG_REG_A_M]    = CFG_A_RESET;
+    m_reg[LSM303AGR_INT_CTRL_REG_M] = INT_CTRL_RESET;
+    m_int_active                    = false;
+
+    mode_update();
+}
+
+/** Threshold comparator flags of INT_SOURCE_REG_M for a sample. */
+static uint8_t comparator(const int32_t value[3])
+{
+    static const uint8_t p_flag[3] = {0x80, 0x40, 0x20}; // P_TH_S_X, P_TH_S_Y, P_TH_S_Z.
+    static const uint8_t n_flag[3] = {0x10, 0x08, 0x04}; // N_TH_S_X, N_TH_S_Y, N_TH_S_Z.
+    static const uint8_t enable[3] = {0x80, 0x40, 0x20}; // XIEN, YIEN, ZIEN.
+
+    int32_t threshold = reg_get_s16(LSM303AGR_INT_THS_L_REG_M) & 0x7FFF; // Unsigned 15 bits.
+    uint8_t flags     = 0;
+
+    for (uint8_t i = 0; i < 3; i++) {
+        if (!(m_reg[LSM303AGR_INT_CTRL_REG_M] & enable[i])) {
+            continue;
+        }
+
+        if (value[i] > threshold) {
+            flags |= p_flag[i];
+        } else if (value[i] < -threshold) {
+            flags |= n_flag[i];
+        }
+    }
+
+    return flags;
+}
+
+/** Complete a measurement: output, status and comparator. */
+static void sample(void)
+{
+    int32_t raw[3];
+    int32_t out[3];
+    bool    overflow = false;
+
+    for (uint8_t i = 0; i < 3; i++) {
+        raw[i] = m_field[i];
+        out[i] = raw[i] - reg_get_s16(LSM303AGR_OFFSET_X_REG_L_M + 2 * i);
+
+        if ((out[i] > INT16_MAX) || (out[i] < INT16_MIN)) {
+            out[i]   = (out[i] > 0) ? INT16_MAX : INT16_MIN;
+            overflow = true;
+        }
+
+        uint8_t lo = (uint8_t)(out[i] & 0xFF);
+        uint8_t hi = (uint8_t)((out[i] >> 8) & 0xFF);
+        bool    ble = (m_reg[LSM303AGR_CFG_REG_C_M] & CFG_C_BLE) != 0;
+
+        m_reg[LSM303AGR_OUTX_L_REG_M + 2 * i]     = ble ? hi : lo;
+        m_reg[LSM303AGR_OUTX_L_REG_M + 2 * i + 1] = ble ? lo : hi;
+    }
+
+    m_stats.samples++;
+
+    uint8_t *p_status = &m_reg[LSM303AGR_STATUS_REG_M];
+    if (*p_status & STATUS_ZYXDA) {
+        m_stats.overruns++;
+        *p_status |= STATUS_OR_MASK | STATUS_ZYXOR;
+    }
+    *p_status |= STATUS_DA_MASK | STATUS_ZYXDA;
+
+    uint8_t *p_source = &m_reg[LSM303AGR_INT_SOURCE_REG_M];
+    uint8_t  int_ctrl = m_reg[LSM303AGR_INT_CTRL_REG_M];
+    bool     was      = m_int_active;
+
+    if (overflow) {
+        *p_source |= INT_SOURCE_MROI;
+    }
+
+    if (int_ctrl & INT_CTRL_IEN) {
+        // Comparator checks the raw data unless INT_on_DataOFF selects the corrected output.
+        uint8_t flags = comparator((m_reg[LSM303AGR_CFG_REG_B_M] & CFG_B_INT_ON_DATAOFF) ? out : raw);
+
+        if (int_ctrl & INT_CTRL_IEL) {
+            // Latched until INT_SOURCE_REG_M is read.
+            *p_source |= flags;
+            m_int_active = m_int_active || (flags != 0);
+        } else {
+            *p_source    = (uint8_t)((*p_source & INT_SOURCE_MROI) | flags);
+            m_int_active = flags != 0;
+        }
+    } else {
+        m_int_active = false;
+    }
+
+    *p_source = (uint8_t)((*p_source & ~INT_SOURCE_INT) | (m_int_active ? INT_SOURCE_INT : 0));
+
+    if (m_int_active && !was) {
+        m_stats.interrupts++;
+    }
+
+    // Single mode returns to idle after the measurement.
+    if (m_single) {
+        m_reg[LSM303AGR_CFG_REG_A_M] |= CFG_A_MD_MASK;
+        mode_update();
+    } else {
+        m_next_sample_us += m_sample_period_us;
+    }
+
+    pin_update();
+}
+
+static uint8_t reg_read(uint8_t reg)
+{
+    uint8_t value = m_reg[reg];
+
+    switch (reg) {
+    case LSM303AGR_INT_SOURCE_REG_M:
+        // Reading clears a latched interrupt and the overflow flag.
+        if (m_reg[LSM303AGR_INT_CTRL_REG_M] & INT_CTRL_IEL) {
+            m_reg[reg]   = 0;
+            m_int_active = false;
+        } else {
+            m_reg[reg] &= ~INT_SOURCE_MROI;
+        }
+        break;
+
+    case LSM303AGR_OUTX_H_REG_M:
+    case LSM303AGR_OUTY_H_REG_M:
+    case LSM303AGR_OUTZ_H_REG_M: {
+        // Reading the axis clears its data available and overrun flags.
+        uint8_t axis = (reg - LSM303AGR_OUTX_H_REG_M) / 2;
+
+        m_reg[LSM303AGR_STATUS_REG_M] &= ~((1 << axis) | (0x10 << axis));
+        if (!(m_reg[LSM303AGR_STATUS_REG_M] & STATUS_DA_MASK)) {
+            m_reg[LSM303AGR_STATUS_REG_M] &= ~STATUS_ZYXDA;
+        }
+        if (!(m_reg[LSM303AGR_STATUS_REG_M] & STATUS_OR_MASK)) {
+            m_reg[LSM303AGR_STATUS_REG_M] &= ~STATUS_ZYXOR;
+        }
+    } break;
+
+    default:
+        break;
+    }
+
+    return value;
+}
+
+static void reg_write(uint8_t reg, uint8_t value)
+{
+    if (!reg_is_writable(reg)) {
+        return;
+    }
+
+    if (reg == LSM303AGR_CFG_REG_A_M) {
+        if (value & CFG_A_SOFT_RST) {
+            soft_reset();
+            return;
+        }
+
+        // REBOOT has nothing to reload here.
+        value &= ~CFG_A_REBOOT;
+    }
+
+    m_reg[reg] = value;
+
+    if (reg == LSM303AGR_CFG_REG_A_M) {
+        mode_update();
+    }
+}
+
+static uint64_t device_next_us(void)
+{
+    uint64_t next = m_next_sample_us;
+
+    if ((m_script_index < m_script_count) && (m_script[m_script_index].time_us < next)) {
+        next = m_script[m_script_index].time_us;
+    }
+
+    return next;
+}
+
+static void device_run(uint64_t now_us)
+{
+    // Field changes first, a sample at the same time sees the new field.
+    while ((m_script_index < m_script_count) && (m_script[m_script_index].time_us <= now_us)) {
+        memcpy(m_field, m_script[m_script_index].field, sizeof(m_field));
+        m_script_index++;
+    }
+
+    if (m_next_sample_us <= now_us) {
+        sample();
+    }
+}
+
+static const sim_source_t m_source = {
+    .next_us = device_next_us,
+    .run     = device_run,
+};
+
+void lsm303agr_sim_init(uint32_t int_pin)
+{
+    m_int_pin = int_pin;
+    m_pointer = 0;
+    memset(m_field, 0, sizeof(m_field));
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    soft_reset();
+    pin_update();
+
+    sim_source_register(&m_source);
+}
+
+void lsm303agr_sim_field_set(int16_t x, int16_t y, int16_t z)
+{
+    m_field[0] = x;
+    m_field[1] = y;
+    m_field[2] = z;
+}
+
+void lsm303agr_sim_field_get(int16_t field[3]) { memcpy(field, m_field, sizeof(m_field)); }
+
+bool lsm303agr_sim_script_set(const lsm303agr_sim_point_t *p_points, uint32_t count)
+{
+    if (count > LSM303AGR_SIM_SCRIPT_SIZE) {
+        return false;
+    }
+
+    memcpy(m_script, p_points, count * sizeof(*p_points));
+    m_script_count = count;
+    m_script_index = 0;
+
+    return true;
+}
+
+bool lsm303agr_sim_script_load(const char *p_path)
+{
+    FILE *p_file = fopen(p_path, "r");
+    char  line[128];
+
+    if (p_file == NULL) {
+        return false;
+    }
+
+    m_script_count = 0;
+    m_script_index = 0;
+
+    while (fgets(line, sizeof(line), p_file) != NULL) {
+        double time_ms;
+        int    x, y, z;
+
+        if ((line[0] == '#') || (sscanf(line, "%lf %d %d %d", &time_ms, &x, &y, &z) != 4)) {
+            continue;
+        }
+
+        if (m_script_count == LSM303AGR_SIM_SCRIPT_SIZE) {
+            fclose(p_file);
+            return false;
+        }
+
+        lsm303agr_sim_point_t *p_point = &m_script[m_script_count++];
+
+        p_point->time_us  = (uint64_t)(time_ms * 1000);
+        p_point->field[0] = (int16_t)x;
+        p_point->field[1] = (int16_t)y;
+        p_point->field[2] = (int16_t)z;
+    }
+
+    fclose(p_file);
+
+    return true;
+}
+
+uint32_t lsm303agr_sim_script_get(const lsm303agr_sim_point_t **pp_points)
+{
+    *pp_points = m_script;
+
+    return m_script_count;
+}
+
+/** Write a burst from the register, the address auto-increments on every access. */
+static void burst_write(uint8_t reg, const uint8_t *p_data, size_t len)
+{
+    m_pointer = reg & (REG_COUNT - 1);
+
+    for (size_t i = 0; i < len; i++) {
+        reg_write(m_pointer, p_data[i]);
+        m_pointer = (m_pointer + 1) & (REG_COUNT - 1);
+        m_stats.writes++;
+    }
+
+    pin_update();
+}
+
+/** Read a burst from the address pointer, the address auto-increments on every access. */
+static void burst_read(uint8_t *p_data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        p_data[i] = reg_read(m_pointer);
+        m_pointer = (m_pointer + 1) & (REG_COUNT - 1);
+        m_stats.reads++;
+    }
+
+    pin_update();
+}
+
+bool lsm303agr_sim_i2c_write(uint8_t addr, const uint8_t *p_data, size_t len)
+{
+    if ((addr != LSM303AGR_I2C_ADD_MG) || (m_reg[LSM303AGR_CFG_REG_C_M] & CFG_C_I2C_DIS)) {
+        return false;
+    }
+
+    if (len == 0) {
+        return true;
+    }
+
+    burst_write(p_data[0], &p_data[1], len - 1);
+
+    return true;
+}
+
+bool lsm303agr_sim_i2c_read(uint8_t addr, uint8_t *p_data, size_t len)
+{
+    if ((addr != LSM303AGR_I2C_ADD_MG) || (m_reg[LSM303AGR_CFG_REG_C_M] & CFG_C_I2C_DIS)) {
+        return false;
+    }
+
+    burst_read(p_data, len);
+
+    return true;
+}
+
+void lsm303agr_sim_spi_write(uint8_t cmd, const uint8_t *p_data, size_t len) { burst_write(cmd & SPI_ADDR_MASK, p_data, len); }
+
+void lsm303agr_sim_spi_read(uint8_t cmd, uint8_t *p_data, size_t len)
+{
+    m_pointer = cmd & SPI_ADDR_MASK;
+    burst_read(p_data, len);
+}
+
+void lsm303agr_sim_stats_get(lsm303agr_sim_stats_t *p_stats) { *p_stats = m_stats; }
@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Register level model of the LSM303AGR magnetometer on the simulated I2C and SPI buses.
+ *
+ * Modelled: OFFSET, WHO_AM_I and CFG_REG_A_M..OUTZ_H_REG_M with auto-increment, read only registers, soft reset,
+ * continuous mode at the selected ODR, single mode returning to idle, hard-iron offset, BLE, the threshold comparator
+ * (INT_on_DataOFF, pulsed and latched INT, IEA polarity, MROI), STATUS data ready and overrun and the INT_MAG/DRDY
+ * pin, which carries INT when INT_MAG_PIN is set and DRDY otherwise. Not modelled: the accelerometer (its I2C address
+ * is not acknowledged, lsm303agr_xl_sim.h serves it on SPI), BDU (a transaction is atomic here), self-test, low-pass
+ * filter, noise and offset cancellation.
+ */
+
+/** Conversion time of a single measurement [us]. */
+#ifndef LSM303AGR_SIM_SINGLE_US
+#define LSM303AGR_SIM_SINGLE_US 10000
+#endif
+
+/** Maximum number of field script points. */
+#ifndef LSM303AGR_SIM_SCRIPT_SIZE
+#define LSM303AGR_SIM_SCRIPT_SIZE 65536
+#endif
+
+// Field script point, the field holds until the next point.
+typedef struct {
+    uint64_t time_us;  // Time the field is applied.
+    int16_t  field[3]; // Field on X, Y and Z [LSB], before the hard-iron offset.
+} lsm303agr_sim_point_t;
+
+// Device statistics.
+typedef struct {
+    uint32_t samples;    // Measurements completed.
+    uint32_t overruns;   // Samples overwriting unread data.
+    uint32_t interrupts; // Samples raising INT from inactive.
+    uint32_t reads;      // Register bytes read.
+    uint32_t writes;     // Register bytes written.
+} lsm303agr_sim_stats_t;
+
+/**@brief       Power on the device, registers hold their reset values.
+ *
+ * @param[in]   int_pin   -   Pin connected to INT_MAG/DRDY.
+ */
+void lsm303agr_sim_init(uint32_t int_pin);
+
+/** Apply a field immediately [LSB]. */
+void lsm303agr_sim_field_set(int16_t x, int16_t y, int16_t z);
+
+/** Field currently applied [LSB]. */
+void lsm303agr_sim_field_get(int16_t field[3]);
+
+/**@brief       Replace the field script.
+ *
+ * @param[in]   p_points  -   Points in ascending time order, copied.
+ * @param[in]   count     -   Number of points.
+ *
+ * @retval  True if the script fits.
+ */
+bool lsm303agr_sim_script_set(const lsm303agr_sim_point_t *p_points, uint32_t count);
+
+/**@brief       Load the field script from a text file, one "t_ms x y z" point per line, '#' starts a comment.
+ *
+ * @param[in]   p_path    -   File path.
+ *
+ * @retval  True if the script was loaded.
+ */
+bool lsm303agr_sim_script_load(const char *p_path);
+
+/**@brief       Field script in use.
+ *
+ * @param[out]  pp_points -   Points of the script.
+ *
+ * @retval  Number of points.
+ */
+uint32_t lsm303agr_sim_script_get(const lsm303agr_sim_point_t **pp_points);
+
+/**@brief       I2C write transaction, the first byte selects the register.
+ *
+ * @param[in]   addr      -   Device address.
+ * @param[in]   p_data    -   Register address followed by the payload.
+ * @param[in]   len       -   Length in bytes.
+ *
+ * @retval  False if the address is not acknowledged.
+ */
+bool lsm303agr_sim_i2c_write(uint8_t addr, const uint8_t *p_data, size_t len);
+
+/**@brief       I2C read transaction from the selected register.
+ *
+ * @param[in]   addr      -   Device address.
+ * @param[out]  p_data    -   Received data.
+ * @param[in]   len       -   Length in bytes.
+ *
+ * @retval  False if the address is not acknowledged.
+ */
+bool lsm303agr_sim_i2c_read(uint8_t addr, uint8_t *p_data, size_t len);
+
+/**@brief       SPI write transaction, the payload follows the command byte.
+ *
+ * @param[in]   cmd       -   Command byte, RW and AD(6:0), the address auto-increments.
+ * @param[in]   p_data    -   Payload.
+ * @param[in]   len       -   Length in bytes.
+ */
+void lsm303agr_sim_spi_write(uint8_t cmd, const uint8_t *p_data, size_t len);
+
+/**@brief       SPI read transaction, the data phase follows the command byte.
+ *
+ * @param[in]   cmd       -   Command byte, RW and AD(6:0), the address auto-increments.
+ * @param[out]  p_data    -   Received data.
+ * @param[in]   len       -   Length in bytes.
+ */
+void lsm303agr_sim_spi_read(uint8_t cmd, uint8_t *p_data, size_t len);
+
+/** Device statistics. */
+void lsm303agr_sim_stats_get(lsm303agr_sim_stats_t *p_stats);
@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "lsm303agr_xl_sim.h"
+
+#include "lsm303agr_types.h"
+
+#include <string.h>
+
+#define SPI_MS 0x40        // Address auto-increment.
+#define SPI_ADDR_MASK 0x3F // Register address AD(5:0).
+
+#define REG_COUNT 0x40
+
+static uint8_t m_reg[REG_COUNT]; // Register file.
+
+/** Register address of the access following the one at the address. */
+static uint8_t reg_next(uint8_t cmd, uint8_t reg) { return (cmd & SPI_MS) ? ((reg + 1) & SPI_ADDR_MASK) : reg; }
+
+void lsm303agr_xl_sim_init(void)
+{
+    memset(m_reg, 0, sizeof(m_reg));
+    m_reg[LSM303AGR_WHO_AM_I_A] = LSM303AGR_ID_XL;
+}
+
+void lsm303agr_xl_sim_output_set(int16_t x, int16_t y, int16_t z)
+{
+    const int16_t out[3] = {x, y, z};
+
+    for (uint8_t i = 0; i < 3; i++) {
+        m_reg[LSM303AGR_OUT_X_L_A + (2 * i)]     = (uint8_t)(out[i] & 0xFF);
+        m_reg[LSM303AGR_OUT_X_L_A + (2 * i) + 1] = (uint8_t)((out[i] >> 8) & 0xFF);
+    }
+}
+
+void lsm303agr_xl_sim_spi_write(uint8_t cmd, const uint8_t *p_data, size_t len)
+{
+    uint8_t reg = cmd & SPI_ADDR_MASK;
+
+    for (size_t i = 0; i < len; i++) {
+        // WHO_AM_I_A is read only.
+        if (reg != LSM303AGR_WHO_AM_I_A) {
+            m_reg[reg] = p_data[i];
+        }
+        reg = reg_next(cmd, reg);
+    }
+}
+
+void lsm303agr_xl_sim_spi_read(uint8_t cmd, uint8_t *p_data, size_t len)
+{
+    uint8_t reg = cmd & SPI_ADDR_MASK;
+
+    for (size_t i = 0; i < len; i++) {
+        p_data[i] = m_reg[reg];
+        reg       = reg_next(cmd, reg);
+    }
+}
@@ -0,0 +1,40 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Register level model of the LSM303AGR accelerometer on the simulated SPI bus.
+ *
+ * Modelled: WHO_AM_I_A, a plain register file and OUT_X_L_A..OUT_Z_H_A holding the applied output, the address
+ * auto-increments only when the MS bit of the command byte is set. Not modelled: I2C, measurements, FIFO and
+ * interrupts.
+ */
+
+/** Power on the device, registers hold their reset values. */
+void lsm303agr_xl_sim_init(void);
+
+/** Apply an output, left justified as OUT_X_L_A..OUT_Z_H_A. */
+void lsm303agr_xl_sim_output_set(int16_t x, int16_t y, int16_t z);
+
+/**@brief       SPI write transaction, the payload follows the command byte.
+ *
+ * @param[in]   cmd       -   Command byte, RW, MS and AD(5:0).
+ * @param[in]   p_data    -   Payload.
+ * @param[in]   len       -   Length in bytes.
+ */
+void lsm303agr_xl_sim_spi_write(uint8_t cmd, const uint8_t *p_data, size_t len);
+
+/**@brief       SPI read transaction, the data phase follows the command byte.
+ *
+ * @param[in]   cmd       -   Command byte, RW, MS and AD(5:0).
+ * @param[out]  p_data    -   Received data.
+ * @param[in]   len       -   Length in bytes.
+ */
+void lsm303agr_xl_sim_spi_read(uint8_t cmd, uint8_t *p_data, size_t len);
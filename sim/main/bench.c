@@ -0,0 +1,287 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+/**
+ * Host benchmark of the LSM303AGR drivers against the simulated device.
+ *
+ * lsm303agr.c, lsm303agr_twim.c and lsm303agr_mag.c run unmodified on top of the simulated TWIM bus and GPIOTE.
+ * A magnet approaching and leaving on the X axis is replayed at every output data rate, in pulsed and latched
+ * interrupt mode, and the detection latency and bus traffic are reported.
+ *
+ *     lsm303agr_sim [script [run_ms]]
+ *
+ * With a field script, "t_ms x y z" per line, the script is replayed once at 100 Hz in pulsed mode instead and
+ * the INT edges are logged.
+ */
+
+#include "app_util_platform.h"
+#include "lsm303agr_bus_trace.h"
+#include "lsm303agr_mag.h"
+#include "lsm303agr_sim.h"
+#include "lsm303agr_twim.h"
+#include "nrf_gpio_sim.h"
+#include "nrfx_gpiote.h"
+#include "nrfx_twim_sim.h"
+#include "sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NRF_LOG_MODULE_NAME SIM
+#include "nrfx_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define MAG_INT_PIN 5       // Magnetometer interrupt pin, as config.h.
+#define THRESHOLD 0x300     // Comparator threshold [LSB], as magnetometer.c.
+#define MAGNET_FIELD 2000   // Magnet field on X at the sensor [LSB].
+#define VISITS 10           // Magnet visits in a run.
+#define VISIT_MS 2000       // Period of the visits.
+#define VISIT_ARRIVE_MS 500 // Magnet arrives, relative to the start of the visit.
+#define VISIT_STAY_MS 1000  // Magnet stays at the sensor.
+#define VISIT_PHASE_US 9700 // Visits drift against the sampling grid, samples are hit at different phases.
+
+static const nrfx_twim_t m_twim = NRFX_TWIM_INSTANCE(0);
+
+// Magnet visit.
+typedef struct {
+    uint64_t arrive_us;  // Magnet arrives.
+    uint64_t leave_us;   // Magnet leaves.
+    uint64_t detect_us;  // First INT_SOURCE read with INT set while the magnet is present.
+    uint64_t release_us; // First falling edge after the magnet left, pulsed mode only.
+} visit_t;
+
+static visit_t  m_visits[VISITS];
+static uint32_t m_visit_count = 0;
+static uint32_t m_edges       = 0; // GPIOTE events handled.
+
+static double wall_ms(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec * 1000.0) + (now.tv_nsec / 1000000.0);
+}
+
+/** Visit in progress at the time, NULL before the first one. */
+static visit_t *visit_get(uint64_t time_us)
+{
+    visit_t *p_visit = NULL;
+
+    for (uint32_t i = 0; (i < m_visit_count) && (m_visits[i].arrive_us <= time_us); i++) {
+        p_visit = &m_visits[i];
+    }
+
+    return p_visit;
+}
+
+static void int_pin_handler(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action)
+{
+    uint64_t now     = sim_now_us();
+    visit_t *p_visit = visit_get(now);
+
+    m_edges++;
+    NRFX_LOG_INFO("INT %s.", nrf_gpio_pin_read(pin) ? "rising" : "falling");
+
+    if (!nrf_gpio_pin_read(pin)) {
+        if ((p_visit != NULL) && (now >= p_visit->leave_us) && (p_visit->release_us == 0)) {
+            p_visit->release_us = now;
+        }
+        return;
+    }
+
+    // Blocking read from the GPIOTE interrupt, the TWIM interrupt preempts it.
+    lsm303agr_int_source_t source;
+    if (!lsm303agr_mag_read_int_source(&source)) {
+        NRFX_LOG_WARNING("INT_SOURCE read failed.");
+        return;
+    }
+
+    now = sim_now_us();
+    if (source.INT && (p_visit != NULL) && (now < p_visit->leave_us) && (p_visit->detect_us == 0)) {
+        p_visit->detect_us = now;
+    }
+}
+
+static bool hardware_init(void)
+{
+    nrfx_twim_config_t      twim_config = {.frequency = NRF_TWIM_FREQ_400K, .interrupt_priority = APP_IRQ_PRIORITY_HIGH};
+    nrfx_gpiote_in_config_t in_config   = NRFX_GPIOTE_CONFIG_IN_SENSE_TOGGLE(true);
+
+    lsm303agr_bus_trace_init();
+    lsm303agr_sim_init(MAG_INT_PIN);
+
+    if ((nrfx_twim_init(&m_twim, &twim_config, lsm303agr_twim_event_handler, NULL) != NRFX_SUCCESS) ||
+        (nrfx_gpiote_init() != NRFX_SUCCESS) || (nrfx_gpiote_in_init(MAG_INT_PIN, &in_config, int_pin_handler) != NRFX_SUCCESS)) {
+        return false;
+    }
+
+    nrfx_twim_enable(&m_twim);
+
+    return lsm303agr_init(lsm303agr_twim_bus(&m_twim)) && lsm303agr_mag_init();
+}
+
+/**@brief       Configure the device and run until the time elapsed, the field follows the script meanwhile.
+ *
+ * @param[in]   odr       -   Output data rate.
+ * @param[in]   latched   -   Latched interrupt, pulsed otherwise.
+ * @param[in]   run_us    -   Length of the run.
+ */
+static void run(lsm303agr_odr_t odr, bool latched, uint64_t run_us)
+{
+    lsm303agr_mag_config_t config = {
+        .md            = LSM303AGR_MODE_CONTINUOUS,
+        .odr           = odr,
+        .comp_temp     = LSM303AGR_ENABLE,
+        .int_threshold = THRESHOLD,
+        .int_on_pin    = LSM303AGR_ENABLE,
+        .ble           = LSM303AGR_MAG_BLE_NATIVE,
+        .int_ctrl      = {.IEN  = LSM303AGR_ENABLE,
+                          .IEL  = latched ? LSM303AGR_INT_LATCH : LSM303AGR_INT_PULSE,
+                          .IEA  = LSM303AGR_INT_HIGH,
+                          .XIEN = LSM303AGR_ENABLE,
+                          .YIEN = LSM303AGR_ENABLE,
+                          .ZIEN = LSM303AGR_ENABLE},
+    };
+
+    uint64_t end = sim_now_us() + run_us;
+
+    if (!lsm303agr_mag_set_soft_reset(LSM303AGR_ENABLE) || !lsm303agr_mag_apply_config(&config, true)) {
+        NRFX_LOG_ERROR("Configuration failed.");
+        exit(EXIT_FAILURE);
+    }
+
+    nrfx_gpiote_in_event_enable(MAG_INT_PIN, true);
+
+    while (sim_now_us() < end) {
+        __WFE();
+    }
+
+    nrfx_gpiote_in_event_disable(MAG_INT_PIN);
+}
+
+/** Magnet visits starting now, each one at a different phase of the sampling grid. */
+static void visits_script(void)
+{
+    static const int16_t ambient[3] = {120, -80, 400};
+
+    lsm303agr_sim_point_t script[2 * VISITS];
+    uint64_t              start = sim_now_us();
+
+    for (uint32_t i = 0; i < VISITS; i++) {
+        visit_t *p_visit = &m_visits[i];
+
+        p_visit->arrive_us  = start + (i * VISIT_MS + VISIT_ARRIVE_MS) * 1000ULL + (i * VISIT_PHASE_US);
+        p_visit->leave_us   = p_visit->arrive_us + (VISIT_STAY_MS * 1000ULL);
+        p_visit->detect_us  = 0;
+        p_visit->release_us = 0;
+
+        script[2 * i]     = (lsm303agr_sim_point_t){.time_us = p_visit->arrive_us, .field = {MAGNET_FIELD, ambient[1], ambient[2]}};
+        script[2 * i + 1] = (lsm303agr_sim_point_t){.time_us = p_visit->leave_us, .field = {ambient[0], ambient[1], ambient[2]}};
+    }
+
+    m_visit_count = VISITS;
+    lsm303agr_sim_field_set(ambient[0], ambient[1], ambient[2]);
+    lsm303agr_sim_script_set(script, ARRAY_SIZE(script));
+}
+
+/** Format mean and maximum of the latencies [ms], "-" if none was measured. */
+static void latency_format(char *p_buf, size_t size, bool release)
+{
+    uint64_t sum   = 0;
+    uint64_t max   = 0;
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < m_visit_count; i++) {
+        uint64_t stamp = release ? m_visits[i].release_us : m_visits[i].detect_us;
+        uint64_t from  = release ? m_visits[i].leave_us : m_visits[i].arrive_us;
+
+        if (stamp != 0) {
+            sum += stamp - from;
+            max = MAX(max, stamp - from);
+            count++;
+        }
+    }
+
+    if (count == 0) {
+        snprintf(p_buf, size, "-");
+    } else {
+        snprintf(p_buf, size, "%.1f/%.1f", (sum / count) / 1000.0, max / 1000.0);
+    }
+}
+
+/** Replay the magnet visits at every output data rate in both interrupt modes. */
+static void benchmark(void)
+{
+    static const uint32_t odr_hz[] = {10, 20, 50, 100};
+
+    printf("%-4s %-8s %14s %14s %6s %10s %7s %9s\n", "ODR", "INT", "detect [ms]", "release [ms]", "edges", "transfers", "bytes",
+           "bus [ms]");
+
+    for (lsm303agr_odr_t odr = LSM303AGR_ODR_10; odr <= LSM303AGR_ODR_100; odr++) {
+        for (uint8_t latched = 0; latched < 2; latched++) {
+            sim_twim_stats_t before;
+            sim_twim_stats_t after;
+            char             detect[32];
+            char             release[32];
+
+            visits_script();
+            m_edges = 0;
+
+            sim_twim_stats_get(&before);
+            run(odr, latched, (VISITS * VISIT_MS) * 1000ULL);
+            sim_twim_stats_get(&after);
+
+            latency_format(detect, sizeof(detect), false);
+            latency_format(release, sizeof(release), true);
+
+            printf("%-4u %-8s %14s %14s %6u %10u %7u %9.3f\n", odr_hz[odr], latched ? "latched" : "pulsed", detect, release, m_edges,
+                   after.transfers - before.transfers, after.bytes - before.bytes, (after.bus_us - before.bus_us) / 1000.0);
+        }
+    }
+
+    printf("Latency as mean/max over %u visits.\n", VISITS);
+}
+
+int main(int argc, char *argv[])
+{
+    double wall_start = wall_ms();
+
+    if (!hardware_init()) {
+        NRFX_LOG_ERROR("LSM303AGR is not found.");
+        return EXIT_FAILURE;
+    }
+
+    if (argc > 1) {
+        if (!lsm303agr_sim_script_load(argv[1])) {
+            NRFX_LOG_ERROR("Field script %s can not be loaded.", argv[1]);
+            return EXIT_FAILURE;
+        }
+
+        run(LSM303AGR_ODR_100, false, (argc > 2) ? strtoull(argv[2], NULL, 0) * 1000ULL : (VISIT_MS * 1000ULL));
+        printf("%u edges.\n", m_edges);
+    } else {
+        benchmark();
+    }
+
+    sim_twim_stats_t      twim;
+    sim_gpio_stats_t      gpio;
+    lsm303agr_sim_stats_t device;
+
+    sim_twim_stats_get(&twim);
+    sim_gpio_stats_get(&gpio);
+    lsm303agr_sim_stats_get(&device);
+
+    printf("Bus: %u transfers, %u bytes, %u NACK, %u busy, %.3f ms busy.\n", twim.transfers, twim.bytes, twim.nacks, twim.busy,
+           twim.bus_us / 1000.0);
+    printf("Device: %u samples, %u overruns, %u interrupts, %u bytes read, %u bytes written.\n", device.samples, device.overruns,
+           device.interrupts, device.reads, device.writes);
+    printf("Pin: %u edges, %u GPIOTE events.\n", gpio.edges, gpio.events);
+    printf("Simulated %.3f s in %.3f ms.\n", sim_now_us() / 1000000.0, wall_ms() - wall_start);
+
+    return EXIT_SUCCESS;
+}
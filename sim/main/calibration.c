@@ -0,0 +1,151 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+/**
+ * Host check of the hard-iron calibration through the detection logic.
+ *
+ * magnetometer.c runs unmodified on top of the simulated device, TWIM bus, GPIOTE and RTC. The device is rotated
+ * through a field sphere around a known hard-iron offset during magnetometer_calibrate(), the offset reported by
+ * MAGNETOMETER_EVENT_CALIBRATED must match it. The comparator must then see the offset-corrected field: a field
+ * below the assert threshold after the offset, but above it before, must not be detected, a field above it after
+ * the offset must be.
+ *
+ *     lsm303agr_calibration
+ *
+ * Exits with EXIT_FAILURE if a check fails.
+ */
+
+#include "lsm303agr_sim.h"
+#include "magnetometer.h"
+#include "sim.h"
+#include "sim_app.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NRF_LOG_MODULE_NAME SIM
+#include "nrfx_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define THRESHOLD_ASSERT 0x300      // Field to detect the magnet [LSB], as magnetometer.c.
+#define SPHERE_RADIUS 400           // Ambient field rotated through [LSB].
+#define SPHERE_POINTS 600           // Orientations of the rotation.
+#define SPHERE_STEP_MS 100          // Time at each orientation, one sample at 10 Hz.
+#define SETTLE_MS 2000              // Time to settle after start and after a field change.
+#define TOLERANCE 10                // Allowed error of the calibrated offset [LSB].
+
+static const int16_t m_offset[3] = {300, -200, 150}; // Hard-iron offset of the board [LSB].
+
+static bool                m_calibrated = false; // MAGNETOMETER_EVENT_CALIBRATED delivered.
+static bool                m_cal_failed = false; // MAGNETOMETER_EVENT_CALIBRATION_FAILED delivered.
+static lsm303agr_mag_raw_t m_cal_offset;         // Offset of the calibration event.
+static bool                m_detected = false;   // Last reported magnet state.
+
+static void magnetometer_event_handler(const magnetometer_evt_t *p_evt)
+{
+    switch (p_evt->type) {
+    case MAGNETOMETER_EVENT_CALIBRATED:
+        m_calibrated = true;
+        m_cal_offset = p_evt->field;
+        break;
+
+    case MAGNETOMETER_EVENT_CALIBRATION_FAILED:
+        m_cal_failed = true;
+        break;
+
+    case MAGNETOMETER_EVENT_MAGNET_DETECTED:
+    case MAGNETOMETER_EVENT_MAGNET_NOT_DETECTED:
+        m_detected = (p_evt->type == MAGNETOMETER_EVENT_MAGNET_DETECTED);
+        break;
+
+    default:
+        break;
+    }
+}
+
+/** Rotate the board through a sphere of orientations, spread evenly on a Fibonacci spiral, from now on. */
+static void sphere_script(void)
+{
+    static lsm303agr_sim_point_t script[SPHERE_POINTS];
+
+    uint64_t start_us = sim_now_us();
+
+    for (uint32_t i = 0; i < SPHERE_POINTS; i++) {
+        double z   = 1.0 - ((2.0 * i + 1.0) / SPHERE_POINTS);
+        double r   = sqrt(1.0 - (z * z));
+        double phi = i * 2.399963229728653; // Golden angle [rad].
+
+        script[i].time_us  = start_us + (i * SPHERE_STEP_MS * 1000ULL);
+        script[i].field[0] = (int16_t)lround(m_offset[0] + (SPHERE_RADIUS * r * cos(phi)));
+        script[i].field[1] = (int16_t)lround(m_offset[1] + (SPHERE_RADIUS * r * sin(phi)));
+        script[i].field[2] = (int16_t)lround(m_offset[2] + (SPHERE_RADIUS * z));
+    }
+
+    lsm303agr_sim_script_set(script, SPHERE_POINTS);
+}
+
+/**@brief       Apply a field relative to the hard-iron offset and check the reported magnet state.
+ *
+ * @param[in]   x         -   Field on X after the offset [LSB].
+ * @param[in]   detected  -   Expected magnet state.
+ *
+ * @retval  True if the expected state was reported.
+ */
+static bool comparator_check(int16_t x, bool detected)
+{
+    lsm303agr_sim_field_set(m_offset[0] + x, m_offset[1], m_offset[2]);
+    sim_app_run_ms(SETTLE_MS);
+
+    printf("Field %d on X after the offset, %d before: %s, expected %s.\n", x, m_offset[0] + x, m_detected ? "detected" : "not detected",
+           detected ? "detected" : "not detected");
+
+    return m_detected == detected;
+}
+
+int main(void)
+{
+    bool ok = true;
+
+    if (!sim_app_init(magnetometer_event_handler)) {
+        NRFX_LOG_ERROR("LSM303AGR is not found.");
+        return EXIT_FAILURE;
+    }
+
+    // Offset must hold the calibration, ambient field tracking would move it.
+    magnetometer_set_baseline_tracking(false);
+
+    lsm303agr_sim_field_set(m_offset[0], m_offset[1], m_offset[2]);
+    magnetometer_start();
+    sim_app_run_ms(SETTLE_MS);
+
+    sphere_script();
+    if (!magnetometer_calibrate(SPHERE_POINTS * SPHERE_STEP_MS)) {
+        NRFX_LOG_ERROR("Calibration did not start.");
+        return EXIT_FAILURE;
+    }
+    sim_app_run_ms((SPHERE_POINTS * SPHERE_STEP_MS) + SETTLE_MS);
+
+    if (!m_calibrated || m_cal_failed) {
+        printf("Calibration failed.\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("Calibrated offset %d %d %d, board offset %d %d %d.\n", m_cal_offset.axis[0], m_cal_offset.axis[1], m_cal_offset.axis[2],
+           m_offset[0], m_offset[1], m_offset[2]);
+
+    for (uint8_t i = 0; i < 3; i++) {
+        ok = ok && (abs(m_cal_offset.axis[i] - m_offset[i]) <= TOLERANCE);
+    }
+
+    // Above the assert threshold only before the offset is subtracted, then above it after.
+    ok = comparator_check(THRESHOLD_ASSERT - 0x100, false) && ok;
+    ok = comparator_check(THRESHOLD_ASSERT + 0x100, true) && ok;
+
+    printf("%s\n", ok ? "Calibration check passed." : "Calibration check FAILED.");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
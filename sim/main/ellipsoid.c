@@ -0,0 +1,280 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+/**
+ * Host check of the soft-iron calibration on synthetic distorted data.
+ *
+ * The ambient field is rotated through all orientations, then distorted by a known soft-iron matrix and hard-iron
+ * offset. The fit of magnetometer_ellipsoid.c must find the offset and map the samples back on a sphere: once on
+ * the samples directly, and once through magnetometer.c on the simulated device, where magnetometer_calibrate()
+ * collects the samples and magnetometer_measure_once() reports them corrected.
+ *
+ *     lsm303agr_ellipsoid
+ *
+ * Exits with EXIT_FAILURE if a check fails.
+ */
+
+#include "lsm303agr_sim.h"
+#include "magnetometer.h"
+#include "magnetometer_ellipsoid.h"
+#include "sim.h"
+#include "sim_app.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NRF_LOG_MODULE_NAME SIM
+#include "nrfx_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define FIELD_RADIUS 400            // Ambient field [LSB].
+#define NOISE_LSB 2                 // Peak sample noise [LSB].
+#define FIT_POINTS 1000             // Orientations of the direct fit.
+#define SPHERE_POINTS 600           // Orientations of the calibration rotation.
+#define SPHERE_STEP_MS 100          // Time at each orientation, one sample at 10 Hz.
+#define CHECK_POINTS 50             // Orientations measured after the calibration.
+#define SETTLE_MS 2000              // Time to settle after start.
+#define CENTER_TOLERANCE 5          // Allowed error of the fitted offset [LSB].
+#define SPREAD_MAX 0.01             // Allowed relative deviation of the corrected field magnitude.
+
+static const int16_t m_offset[3] = {300, -200, 150}; // Hard-iron offset of the board [LSB].
+
+static double   m_distortion[3][3]; // Soft-iron distortion of the board.
+static uint32_t m_seed = 1;
+
+static bool                m_calibrated = false; // MAGNETOMETER_EVENT_CALIBRATED delivered.
+static lsm303agr_mag_raw_t m_cal_offset;         // Offset of the calibration event.
+
+// Field magnitude statistics.
+typedef struct {
+    double   sum;    // Sum of the magnitudes.
+    double   sum_sq; // Sum of the squared magnitudes.
+    double   max;    // Largest magnitude.
+    double   min;    // Smallest magnitude.
+    uint32_t count;  // Number of samples.
+} spread_t;
+
+/** Deterministic pseudo random number in [-range, range]. */
+static int32_t noise_get(int32_t range)
+{
+    m_seed = (m_seed * 1103515245) + 12345;
+
+    return (int32_t)(((m_seed >> 16) & 0x7FFF) % (2 * range + 1)) - range;
+}
+
+/** Soft-iron distortion, semi-axes 1.25, 0.85 and 1.0 turned 30 degrees about Z and 20 degrees about X. */
+static void distortion_build(void)
+{
+    const double axes[3]  = {1.25, 0.85, 1.0};
+    const double a        = 30 * M_PI / 180;
+    const double b        = 20 * M_PI / 180;
+    const double rz[3][3] = {{cos(a), -sin(a), 0}, {sin(a), cos(a), 0}, {0, 0, 1}};
+    const double rx[3][3] = {{1, 0, 0}, {0, cos(b), -sin(b)}, {0, sin(b), cos(b)}};
+    double       r[3][3];
+
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            r[i][j] = rx[i][0] * rz[0][j] + rx[i][1] * rz[1][j] + rx[i][2] * rz[2][j];
+        }
+    }
+
+    // D = R * diag(axes) * R^T.
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            m_distortion[i][j] = 0;
+
+            for (uint8_t k = 0; k < 3; k++) {
+                m_distortion[i][j] += r[i][k] * axes[k] * r[j][k];
+            }
+        }
+    }
+}
+
+/**@brief       Output of the board at an orientation of a Fibonacci spiral, distorted and with noise.
+ *
+ * @param[in]   index     -   Orientation.
+ * @param[in]   count     -   Orientations of the spiral.
+ * @param[out]  field     -   Field at the sensor [LSB].
+ */
+static void board_field_get(uint32_t index, uint32_t count, int16_t field[3])
+{
+    double z    = 1.0 - ((2.0 * index + 1.0) / count);
+    double r    = sqrt(1.0 - (z * z));
+    double phi  = index * 2.399963229728653; // Golden angle [rad].
+    double u[3] = {FIELD_RADIUS * r * cos(phi), FIELD_RADIUS * r * sin(phi), FIELD_RADIUS * z};
+
+    for (uint8_t i = 0; i < 3; i++) {
+        double out = m_offset[i] + m_distortion[i][0] * u[0] + m_distortion[i][1] * u[1] + m_distortion[i][2] * u[2];
+
+        field[i] = (int16_t)lround(out + noise_get(NOISE_LSB));
+    }
+}
+
+static void spread_add(spread_t *p_spread, const int16_t axis[3])
+{
+    double magnitude = sqrt((double)axis[0] * axis[0] + (double)axis[1] * axis[1] + (double)axis[2] * axis[2]);
+
+    p_spread->max = (p_spread->count == 0) ? magnitude : fmax(p_spread->max, magnitude);
+    p_spread->min = (p_spread->count == 0) ? magnitude : fmin(p_spread->min, magnitude);
+    p_spread->sum += magnitude;
+    p_spread->sum_sq += magnitude * magnitude;
+    p_spread->count++;
+}
+
+/** Standard deviation of the magnitude relative to its mean. */
+static double spread_get(const spread_t *p_spread)
+{
+    double mean = p_spread->sum / p_spread->count;
+
+    return sqrt(fmax(0, (p_spread->sum_sq / p_spread->count) - (mean * mean))) / mean;
+}
+
+static void spread_print(const char *p_name, const spread_t *p_spread)
+{
+    printf("%-9s |B| %.1f mean, %.1f..%.1f, %.2f%% deviation.\n", p_name, p_spread->sum / p_spread->count, p_spread->min,
+           p_spread->max, 100 * spread_get(p_spread));
+}
+
+/** Center of a fit or a calibration within the tolerance of the board offset. */
+static bool center_check(const char *p_name, const int16_t center[3])
+{
+    bool ok = true;
+
+    printf("%s offset %d %d %d, board offset %d %d %d.\n", p_name, center[0], center[1], center[2], m_offset[0], m_offset[1],
+           m_offset[2]);
+
+    for (uint8_t i = 0; i < 3; i++) {
+        ok = ok && (abs(center[i] - m_offset[i]) <= CENTER_TOLERANCE);
+    }
+
+    return ok;
+}
+
+/** Fit the distorted samples directly and correct them. */
+static bool fit_check(void)
+{
+    magnetometer_ellipsoid_t            fit;
+    magnetometer_ellipsoid_correction_t corr;
+    spread_t                            raw       = {0};
+    spread_t                            corrected = {0};
+
+    magnetometer_ellipsoid_init(&fit);
+
+    for (uint32_t i = 0; i < FIT_POINTS; i++) {
+        lsm303agr_mag_raw_t sample;
+
+        board_field_get(i, FIT_POINTS, sample.axis);
+        magnetometer_ellipsoid_add(&fit, &sample);
+    }
+
+    if (!magnetometer_ellipsoid_solve(&fit, &corr)) {
+        printf("Fit failed.\n");
+        return false;
+    }
+
+    for (uint32_t i = 0; i < FIT_POINTS; i++) {
+        lsm303agr_mag_raw_t sample, centered;
+
+        board_field_get(i, FIT_POINTS, sample.axis);
+
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            centered.axis[axis] = sample.axis[axis] - m_offset[axis];
+        }
+        spread_add(&raw, centered.axis);
+
+        magnetometer_ellipsoid_apply(&corr, &sample, &sample);
+        spread_add(&corrected, sample.axis);
+    }
+
+    spread_print("Raw", &raw);
+    spread_print("Corrected", &corrected);
+
+    return center_check("Fitted", corr.center) && (spread_get(&corrected) < SPREAD_MAX);
+}
+
+static void magnetometer_event_handler(const magnetometer_evt_t *p_evt)
+{
+    if (p_evt->type == MAGNETOMETER_EVENT_CALIBRATED) {
+        m_calibrated = true;
+        m_cal_offset = p_evt->field;
+    }
+}
+
+/** Calibrate through magnetometer.c while the board is rotated, then measure at other orientations. */
+static bool calibration_check(void)
+{
+    static lsm303agr_sim_point_t script[SPHERE_POINTS];
+
+    spread_t corrected = {0};
+    uint64_t start_us;
+
+    if (!sim_app_init(magnetometer_event_handler)) {
+        NRFX_LOG_ERROR("LSM303AGR is not found.");
+        return false;
+    }
+
+    // Offset must hold the calibration, ambient field tracking would move it.
+    magnetometer_set_baseline_tracking(false);
+
+    board_field_get(0, SPHERE_POINTS, script[0].field);
+    lsm303agr_sim_field_set(script[0].field[0], script[0].field[1], script[0].field[2]);
+    magnetometer_start();
+    sim_app_run_ms(SETTLE_MS);
+
+    start_us = sim_now_us();
+    for (uint32_t i = 0; i < SPHERE_POINTS; i++) {
+        script[i].time_us = start_us + (i * SPHERE_STEP_MS * 1000ULL);
+        board_field_get(i, SPHERE_POINTS, script[i].field);
+    }
+    lsm303agr_sim_script_set(script, SPHERE_POINTS);
+
+    if (!magnetometer_calibrate(SPHERE_POINTS * SPHERE_STEP_MS)) {
+        NRFX_LOG_ERROR("Calibration did not start.");
+        return false;
+    }
+    sim_app_run_ms((SPHERE_POINTS * SPHERE_STEP_MS) + SETTLE_MS);
+
+    if (!m_calibrated) {
+        printf("Calibration failed.\n");
+        return false;
+    }
+
+    // Single measurements at orientations of another spiral go through the correction.
+    magnetometer_stop();
+
+    for (uint32_t i = 0; i < CHECK_POINTS; i++) {
+        int16_t             field[3];
+        lsm303agr_mag_raw_t sample;
+
+        board_field_get(i, CHECK_POINTS, field);
+        lsm303agr_sim_field_set(field[0], field[1], field[2]);
+
+        if (!magnetometer_measure_once(&sample)) {
+            printf("Measurement %u failed.\n", i);
+            return false;
+        }
+        spread_add(&corrected, sample.axis);
+    }
+
+    spread_print("Measured", &corrected);
+
+    return center_check("Calibrated", m_cal_offset.axis) && (spread_get(&corrected) < SPREAD_MAX);
+}
+
+int main(void)
+{
+    bool ok;
+
+    distortion_build();
+
+    ok = fit_check();
+    ok = calibration_check() && ok;
+
+    printf("%s\n", ok ? "Ellipsoid check passed." : "Ellipsoid check FAILED.");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,412 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+/**
+ * Host replay of door traffic through the magnet detection logic.
+ *
+ * magnetometer.c runs unmodified with its app_timer timers, scheduler and event queue on top of the simulated
+ * device, TWIM bus, GPIOTE and RTC. Virtual time jumps from one event to the next, a day is replayed in seconds.
+ *
+ *     lsm303agr_replay [script [run_ms]]
+ *
+ * Without arguments a day of door traffic is generated, the door magnet sits on X and the ambient field drifts
+ * slowly. A recorded field script, "t_ms x y z" per line, may be replayed instead. The expected magnet state follows
+ * the field of the script with the detection thresholds of magnetometer.c, the reported events are matched against
+ * it for the detection and release latency. The magnetometer is then stopped and single measurements are repeated
+ * back to back and periodically, each one must be read. Last, the magnetometer is stopped within the debounce time of
+ * a start, nothing may touch the bus or report an event after MAGNETOMETER_EVENT_STOP.
+ */
+
+#include "app_scheduler.h"
+#include "app_timer_sim.h"
+#include "lsm303agr_sim.h"
+#include "magnetometer.h"
+#include "nrf_gpio_sim.h"
+#include "nrfx_twim_sim.h"
+#include "sim.h"
+#include "sim_app.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NRF_LOG_MODULE_NAME SIM
+#include "nrfx_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define THRESHOLD_ASSERT 0x300      // Field to detect the magnet [LSB], as magnetometer.c.
+#define THRESHOLD_RELEASE 0x200     // Field to release the magnet [LSB], as magnetometer.c.
+#define MAGNET_FIELD 2000           // Door magnet field on X at the sensor when the door is closed [LSB].
+#define DAY_US (24 * 3600 * 1000000ULL)
+#define DRIFT_STEP_US (600 * 1000000ULL) // Ambient field changes every 10 minutes.
+#define DRIFT_LSB 60                     // Peak ambient drift over the day [LSB].
+#define TAIL_US (10 * 1000000ULL)        // Run past the last script point.
+#define MAX_TRANSITIONS 8192
+#define MAX_EVENTS 8192
+#define MEASUREMENTS 8                   // Repeated single measurements.
+#define MEASURE_PERIOD_MS 100            // Period of the periodic single measurements.
+#define STOP_AFTER_MS 5                  // Stop after start, within the debounce time of magnetometer.c.
+#define STOP_RUN_MS 1000                 // Run after the stop.
+
+
+// Magnet state change, expected or reported.
+typedef struct {
+    uint64_t time_us;  // Field change or event delivery to the main loop.
+    bool     detected; // New magnet state.
+} transition_t;
+
+static transition_t m_expected[MAX_TRANSITIONS];
+static uint32_t     m_expected_count = 0;
+static transition_t m_reported[MAX_EVENTS];
+static uint32_t     m_reported_count = 0;
+static uint32_t     m_events         = 0; // Events delivered, any type.
+static uint32_t     m_samples        = 0; // MAGNETOMETER_EVENT_SAMPLE delivered.
+static bool         m_stopped        = false; // MAGNETOMETER_EVENT_STOP is the last start or stop event delivered.
+static uint32_t     m_after_stop     = 0;     // Events delivered after MAGNETOMETER_EVENT_STOP.
+
+static uint32_t m_seed = 1;
+
+static double wall_ms(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec * 1000.0) + (now.tv_nsec / 1000000.0);
+}
+
+/** Deterministic pseudo random number in [min, max]. */
+static uint32_t random_range(uint32_t min, uint32_t max)
+{
+    m_seed = (m_seed * 1103515245) + 12345;
+
+    return min + (((m_seed >> 16) & 0x7FFF) % (max - min + 1));
+}
+
+static void magnetometer_event_handler(const magnetometer_evt_t *p_evt)
+{
+    m_events++;
+
+    if ((p_evt->type == MAGNETOMETER_EVENT_START) || (p_evt->type == MAGNETOMETER_EVENT_STOP)) {
+        m_stopped = (p_evt->type == MAGNETOMETER_EVENT_STOP);
+    } else if (m_stopped) {
+        m_after_stop++;
+    }
+
+    if (p_evt->type == MAGNETOMETER_EVENT_SAMPLE) {
+        m_samples++;
+    }
+
+    if ((p_evt->type != MAGNETOMETER_EVENT_MAGNET_DETECTED) && (p_evt->type != MAGNETOMETER_EVENT_MAGNET_NOT_DETECTED)) {
+        return;
+    }
+
+    NRFX_LOG_INFO("%s.", (p_evt->type == MAGNETOMETER_EVENT_MAGNET_DETECTED) ? "Detected" : "Not detected");
+
+    if (m_reported_count < MAX_EVENTS) {
+        m_reported[m_reported_count].time_us  = sim_now_us();
+        m_reported[m_reported_count].detected = (p_evt->type == MAGNETOMETER_EVENT_MAGNET_DETECTED);
+        m_reported_count++;
+    }
+}
+
+/** Ambient field at the time, drifts up and down once a day. */
+static void ambient_get(uint64_t time_us, int16_t field[3])
+{
+    static const int16_t base[3] = {120, -80, 400};
+
+    // Triangle wave, peak at noon.
+    int32_t phase = (int32_t)((time_us % DAY_US) / DRIFT_STEP_US);
+    int32_t steps = (int32_t)(DAY_US / DRIFT_STEP_US);
+    int32_t drift = (DRIFT_LSB * (steps / 2 - abs(phase - steps / 2))) / (steps / 2);
+
+    field[0] = base[0] + drift;
+    field[1] = base[1] - drift / 2;
+    field[2] = base[2] + drift;
+}
+
+/**@brief       Append a script point with the door state at the time.
+ *
+ * @param[out]  p_script  -   Script.
+ * @param[in]   p_count   -   Number of points, incremented.
+ * @param[in]   time_us   -   Time of the point.
+ * @param[in]   closed    -   Door is closed, the magnet is at the sensor.
+ */
+static void point_add(lsm303agr_sim_point_t *p_script, uint32_t *p_count, uint64_t time_us, bool closed)
+{
+    lsm303agr_sim_point_t *p_point = &p_script[(*p_count)++];
+
+    p_point->time_us = time_us;
+    ambient_get(time_us, p_point->field);
+
+    if (closed) {
+        p_point->field[0] += MAGNET_FIELD;
+    }
+}
+
+/** Generate a day of door traffic, short passes and a few long airings between 07:00 and 22:00. */
+static void day_script(void)
+{
+    static lsm303agr_sim_point_t script[LSM303AGR_SIM_SCRIPT_SIZE];
+
+    uint32_t count      = 0;
+    uint64_t next_drift = 0;
+    uint64_t next_open  = 7 * 3600 * 1000000ULL;
+    uint64_t next_close = 0;
+    bool     closed     = true;
+
+    // Door edges and drift steps in time order, a door edge refreshes the ambient field too.
+    while ((next_drift < DAY_US) && (count < LSM303AGR_SIM_SCRIPT_SIZE)) {
+        uint64_t next_door = closed ? next_open : next_close;
+
+        if ((next_door <= next_drift) && (next_door < DAY_US)) {
+            closed = !closed;
+            point_add(script, &count, next_door, closed);
+
+            if (closed) {
+                next_open = next_door + random_range(60, 900) * 1000000ULL;
+                if (next_open >= 22 * 3600 * 1000000ULL) {
+                    next_open += 9 * 3600 * 1000000ULL;
+                }
+            } else {
+                uint32_t open_ms = (random_range(0, 19) == 0) ? random_range(600, 1800) * 1000 : random_range(3000, 60000);
+
+                next_close = next_door + open_ms * 1000ULL;
+            }
+        } else {
+            point_add(script, &count, next_drift, closed);
+            next_drift += DRIFT_STEP_US;
+        }
+    }
+
+    lsm303agr_sim_script_set(script, count);
+}
+
+/** Expected magnet state changes of the script, the field crosses the thresholds with hysteresis. */
+static void expected_build(void)
+{
+    const lsm303agr_sim_point_t *p_points;
+    uint32_t                     count    = lsm303agr_sim_script_get(&p_points);
+    bool                         detected = false;
+    int16_t                      field[3];
+
+    // Initial state is reported after start.
+    lsm303agr_sim_field_get(field);
+
+    for (uint32_t i = 0; i <= count; i++) {
+        uint64_t time_us = (i == 0) ? 0 : p_points[i - 1].time_us;
+        int32_t  peak    = 0;
+
+        if (i > 0) {
+            memcpy(field, p_points[i - 1].field, sizeof(field));
+        }
+
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            peak = MAX(peak, abs(field[axis]));
+        }
+
+        bool state = detected ? (peak > THRESHOLD_RELEASE) : (peak > THRESHOLD_ASSERT);
+
+        if (((i == 0) || (state != detected)) && (m_expected_count < MAX_TRANSITIONS)) {
+            m_expected[m_expected_count].time_us  = time_us;
+            m_expected[m_expected_count].detected = state;
+            m_expected_count++;
+        }
+
+        detected = state;
+    }
+}
+
+// Latency accumulator [us].
+typedef struct {
+    uint64_t sum;
+    uint64_t max;
+    uint32_t count;
+} latency_t;
+
+static void latency_add(latency_t *p_latency, uint64_t latency_us)
+{
+    p_latency->sum += latency_us;
+    p_latency->max = MAX(p_latency->max, latency_us);
+    p_latency->count++;
+}
+
+static void latency_print(const char *p_name, const latency_t *p_latency)
+{
+    if (p_latency->count == 0) {
+        printf("%-9s latency: -\n", p_name);
+        return;
+    }
+
+    printf("%-9s latency: %.1f ms mean, %.1f ms max over %u transitions.\n", p_name, (p_latency->sum / p_latency->count) / 1000.0,
+           p_latency->max / 1000.0, p_latency->count);
+}
+
+/** Match the reported events against the expected state changes and print the latencies. */
+static void report(void)
+{
+    latency_t detect   = {0};
+    latency_t release  = {0};
+    uint32_t  next     = 0; // Next unmatched expected change.
+    uint32_t  missed   = 0;
+    uint32_t  spurious = 0;
+
+    for (uint32_t i = 0; i < m_reported_count; i++) {
+        const transition_t *p_event = &m_reported[i];
+        int32_t             match   = -1;
+
+        // Latest change to the reported state, changes skipped on the way were shorter than the detection.
+        for (uint32_t j = next; (j < m_expected_count) && (m_expected[j].time_us <= p_event->time_us); j++) {
+            if (m_expected[j].detected == p_event->detected) {
+                match = (int32_t)j;
+            }
+        }
+
+        if (match < 0) {
+            spurious++;
+            NRFX_LOG_WARNING("Spurious %s at %.3f s.", p_event->detected ? "detection" : "release", p_event->time_us / 1000000.0);
+            continue;
+        }
+
+        missed += match - next;
+        next = match + 1;
+
+        latency_add(p_event->detected ? &detect : &release, p_event->time_us - m_expected[match].time_us);
+    }
+
+    // Changes too close to the end of the run are not counted as missed.
+    while ((next < m_expected_count) && (m_expected[next].time_us + (TAIL_US / 2) < sim_now_us())) {
+        missed++;
+        next++;
+    }
+
+    printf("Expected %u state changes, %u reported, %u missed, %u spurious.\n", m_expected_count, m_reported_count, missed, spurious);
+    latency_print("Detection", &detect);
+    latency_print("Release", &release);
+}
+
+/**@brief       Repeat single measurements with the magnetometer stopped, the device returns to idle after each one.
+ *
+ * @retval  True if every measurement was read.
+ */
+static bool measure_check(void)
+{
+    lsm303agr_mag_raw_t sample;
+    uint32_t            once = 0;
+
+    magnetometer_stop();
+
+    for (uint32_t i = 0; i < MEASUREMENTS; i++) {
+        once += magnetometer_measure_once(&sample) ? 1 : 0;
+    }
+
+    m_samples = 0;
+    if (magnetometer_measure_periodic_start(MEASURE_PERIOD_MS)) {
+        sim_app_run_ms((MEASUREMENTS * MEASURE_PERIOD_MS) + (MEASURE_PERIOD_MS / 2));
+        magnetometer_measure_periodic_stop();
+    }
+
+    printf("Single measurements: %u/%u back to back, %u/%u periodic.\n", once, MEASUREMENTS, m_samples, MEASUREMENTS);
+
+    return (once == MEASUREMENTS) && (m_samples == MEASUREMENTS);
+}
+
+/**@brief       Stop the magnetometer before the debounce timer of the start expired.
+ *
+ * @retval  True if neither a bus transfer nor an event followed the stop.
+ */
+static bool stop_check(void)
+{
+    sim_twim_stats_t stopped;
+    sim_twim_stats_t twim;
+    int16_t          field[3];
+    bool             detected = (m_reported_count > 0) && m_reported[m_reported_count - 1].detected;
+
+    // Field of the opposite state, the debounce timer would report it.
+    ambient_get(sim_now_us(), field);
+    lsm303agr_sim_field_set(field[0] + (detected ? 0 : MAGNET_FIELD), field[1], field[2]);
+
+    // A wait would sleep until the debounce timer, time is advanced without waiting for an event.
+    magnetometer_start();
+    sim_delay_us(STOP_AFTER_MS * 1000ULL);
+    magnetometer_stop();
+    app_sched_execute();
+
+    m_after_stop = 0;
+    sim_twim_stats_get(&stopped);
+    sim_delay_us(STOP_RUN_MS * 1000ULL);
+    app_sched_execute();
+    sim_twim_stats_get(&twim);
+
+    printf("Stop %u ms after start: %u transfers and %u events after the stop.\n", STOP_AFTER_MS, twim.transfers - stopped.transfers,
+           m_after_stop);
+
+    return (twim.transfers == stopped.transfers) && (m_after_stop == 0);
+}
+
+int main(int argc, char *argv[])
+{
+    double   wall_start = wall_ms();
+    uint64_t end_us;
+
+    if (!sim_app_init(magnetometer_event_handler)) {
+        NRFX_LOG_ERROR("LSM303AGR is not found.");
+        return EXIT_FAILURE;
+    }
+
+    if (argc > 1) {
+        const lsm303agr_sim_point_t *p_points;
+
+        if (!lsm303agr_sim_script_load(argv[1])) {
+            NRFX_LOG_ERROR("Field script %s can not be loaded.", argv[1]);
+            return EXIT_FAILURE;
+        }
+
+        uint32_t count = lsm303agr_sim_script_get(&p_points);
+
+        end_us = (argc > 2) ? strtoull(argv[2], NULL, 0) * 1000ULL : (count > 0 ? p_points[count - 1].time_us : 0) + TAIL_US;
+    } else {
+        day_script();
+        end_us = DAY_US;
+    }
+
+    expected_build();
+    magnetometer_start();
+
+    // Main loop of main.c, the core sleeps until an interrupt.
+    while (sim_now_us() < end_us) {
+        app_sched_execute();
+        __WFE();
+    }
+    app_sched_execute();
+
+    report();
+
+    sim_twim_stats_t      twim;
+    sim_gpio_stats_t      gpio;
+    lsm303agr_sim_stats_t device;
+    app_timer_sim_stats_t timer;
+
+    sim_twim_stats_get(&twim);
+    sim_gpio_stats_get(&gpio);
+    lsm303agr_sim_stats_get(&device);
+    app_timer_sim_stats_get(&timer);
+
+    printf("Events: %u delivered.\n", m_events);
+    printf("Bus: %u transfers, %u bytes, %u NACK, %u busy, %.3f s busy.\n", twim.transfers, twim.bytes, twim.nacks, twim.busy,
+           twim.bus_us / 1000000.0);
+    printf("Device: %u samples, %u overruns, %u interrupts.\n", device.samples, device.overruns, device.interrupts);
+    printf("Pin: %u edges, %u GPIOTE events.\n", gpio.edges, gpio.events);
+    printf("Timers: %u starts, %u timeouts.\n", timer.starts, timer.timeouts);
+    printf("Simulated %.3f s in %.3f ms.\n", sim_now_us() / 1000000.0, wall_ms() - wall_start);
+
+    bool ok = measure_check();
+
+    ok = stop_check() && ok;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+/**
+ * Host check of the 3-wire SPI backend.
+ *
+ * lsm303agr.c, lsm303agr_spim.c, lsm303agr_xl.c and lsm303agr_mag.c run unmodified on top of the simulated SPIM bus.
+ * Burst reads of both devices must return consecutive registers: the accelerometer only increments the address
+ * with the MS bit of the command byte, the magnetometer always does and bit 6 is part of its register address.
+ *
+ *     lsm303agr_spim
+ *
+ * Exits with EXIT_FAILURE if a check fails.
+ */
+
+#include "app_error.h"
+#include "app_util_platform.h"
+#include "lsm303agr.h"
+#include "lsm303agr_mag.h"
+#include "lsm303agr_sim.h"
+#include "lsm303agr_spim.h"
+#include "lsm303agr_xl.h"
+#include "lsm303agr_xl_sim.h"
+#include "nrfx_spim_sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NRF_LOG_MODULE_NAME SIM
+#include "nrfx_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#define MAG_INT_PIN 5 // Magnetometer interrupt pin, as config.h.
+#define CS_XL_PIN 7   // Accelerometer chip select, as config.h.
+#define CS_MAG_PIN 8  // Magnetometer chip select, as config.h.
+
+static const nrfx_spim_t m_spim = NRFX_SPIM_INSTANCE(2);
+
+static const int16_t m_xl_out[3]     = {0x1230, -0x0450, 0x7FF0}; // Accelerometer output, left justified.
+static const int16_t m_mag_offset[3] = {300, -200, 150};          // Hard-iron offset written and read back [LSB].
+
+/** Compare the axes read in a burst with the expected ones. */
+static bool axes_check(const char *p_name, const int16_t read[3], const int16_t expected[3])
+{
+    bool ok = (read[0] == expected[0]) && (read[1] == expected[1]) && (read[2] == expected[2]);
+
+    printf("%s %d %d %d, expected %d %d %d: %s.\n", p_name, read[0], read[1], read[2], expected[0], expected[1], expected[2],
+           ok ? "passed" : "FAILED");
+
+    return ok;
+}
+
+int main(void)
+{
+    nrfx_spim_config_t  config = {.frequency = NRF_SPIM_FREQ_8M, .mode = NRF_SPIM_MODE_3, .irq_priority = APP_IRQ_PRIORITY_HIGH};
+    lsm303agr_xl_raw_t  xl;
+    lsm303agr_mag_raw_t offset = {.axis = {m_mag_offset[0], m_mag_offset[1], m_mag_offset[2]}};
+    lsm303agr_mag_raw_t read   = {0};
+    sim_spim_stats_t    stats;
+    bool                ok;
+
+    lsm303agr_sim_init(MAG_INT_PIN);
+    lsm303agr_xl_sim_init();
+    sim_spim_cs_set(CS_XL_PIN, CS_MAG_PIN);
+
+    APP_ERROR_CHECK(nrfx_spim_init(&m_spim, &config, lsm303agr_spim_event_handler, NULL));
+
+    if (!lsm303agr_init(lsm303agr_spim_bus(&m_spim, CS_XL_PIN, CS_MAG_PIN)) || !lsm303agr_xl_init() || !lsm303agr_mag_init()) {
+        NRFX_LOG_ERROR("LSM303AGR is not found.");
+        return EXIT_FAILURE;
+    }
+
+    // OUT_X_L_A..OUT_Z_H_A in one transfer.
+    lsm303agr_xl_sim_output_set(m_xl_out[0], m_xl_out[1], m_xl_out[2]);
+    ok = lsm303agr_xl_read_raw(&xl) && axes_check("Accelerometer", xl.axis, m_xl_out);
+
+    // OFFSET_X_REG_L_M..OFFSET_Z_REG_H_M written and read back in one transfer each.
+    ok = lsm303agr_mag_set_offset(&offset) && lsm303agr_mag_get_offset(&read) && axes_check("Magnetometer offset", read.axis, m_mag_offset) &&
+         ok;
+
+    sim_spim_stats_get(&stats);
+    printf("%u transfers, %u bytes, %u errors.\n", stats.transfers, stats.bytes, stats.errors);
+
+    ok = ok && (stats.errors == 0);
+    printf("%s\n", ok ? "SPIM check passed." : "SPIM check FAILED.");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
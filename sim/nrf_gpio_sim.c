@@ -0,0 +1,154 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "nrf_gpio_sim.h"
+
+#include "nrfx_gpiote.h"
+#include "sim.h"
+
+// GPIOTE IN event of a pin.
+typedef struct {
+    bool                      configured; // nrfx_gpiote_in_init() was called.
+    bool                      enabled;    // Event enabled with the interrupt.
+    bool                      triggered;  // Event waits for the interrupt handler.
+    nrf_gpiote_polarity_t     sense;      // Edges generating the event.
+    nrfx_gpiote_evt_handler_t handler;    // Event handler.
+} gpiote_in_t;
+
+static bool             m_input[SIM_GPIO_PIN_COUNT];  // Input levels.
+static bool             m_output[SIM_GPIO_PIN_COUNT]; // Output levels.
+static gpiote_in_t      m_in[SIM_GPIO_PIN_COUNT];
+static bool             m_gpiote_init = false;
+static sim_gpio_stats_t m_stats;
+
+static void gpiote_irq_handler(void);
+
+static sim_irq_t m_gpiote_irq = {
+    .handler  = gpiote_irq_handler,
+    .priority = GPIOTE_CONFIG_IRQ_PRIORITY,
+};
+
+static void gpiote_irq_handler(void)
+{
+    for (uint32_t pin = 0; pin < SIM_GPIO_PIN_COUNT; pin++) {
+        gpiote_in_t *p_in = &m_in[pin];
+
+        if (!p_in->triggered) {
+            continue;
+        }
+
+        p_in->triggered = false;
+
+        if (p_in->handler != NULL) {
+            p_in->handler(pin, p_in->sense);
+        }
+    }
+}
+
+void sim_gpio_input_set(uint32_t pin, bool level)
+{
+    if ((pin >= SIM_GPIO_PIN_COUNT) || (m_input[pin] == level)) {
+        return;
+    }
+
+    gpiote_in_t *p_in = &m_in[pin];
+
+    m_input[pin] = level;
+    m_stats.edges++;
+
+    if (!p_in->enabled) {
+        return;
+    }
+
+    if ((p_in->sense == NRF_GPIOTE_POLARITY_TOGGLE) || ((p_in->sense == NRF_GPIOTE_POLARITY_LOTOHI) && level) ||
+        ((p_in->sense == NRF_GPIOTE_POLARITY_HITOLO) && !level)) {
+        m_stats.events++;
+        p_in->triggered = true;
+        sim_irq_pend(&m_gpiote_irq);
+    }
+}
+
+bool sim_gpio_output_get(uint32_t pin) { return (pin < SIM_GPIO_PIN_COUNT) && m_output[pin]; }
+
+void sim_gpio_stats_get(sim_gpio_stats_t *p_stats) { *p_stats = m_stats; }
+
+uint32_t nrf_gpio_pin_read(uint32_t pin_number) { return (pin_number < SIM_GPIO_PIN_COUNT) ? m_input[pin_number] : 0; }
+
+void nrf_gpio_cfg_output(uint32_t pin_number) {}
+
+void nrf_gpio_pin_set(uint32_t pin_number)
+{
+    if (pin_number < SIM_GPIO_PIN_COUNT) {
+        m_output[pin_number] = true;
+    }
+}
+
+void nrf_gpio_pin_clear(uint32_t pin_number)
+{
+    if (pin_number < SIM_GPIO_PIN_COUNT) {
+        m_output[pin_number] = false;
+    }
+}
+
+nrfx_err_t nrfx_gpiote_init(void)
+{
+    if (m_gpiote_init) {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+
+    sim_irq_register(&m_gpiote_irq);
+    m_gpiote_init = true;
+
+    return NRFX_SUCCESS;
+}
+
+bool nrfx_gpiote_is_init(void) { return m_gpiote_init; }
+
+nrfx_err_t nrfx_gpiote_in_init(nrfx_gpiote_pin_t pin, nrfx_gpiote_in_config_t const *p_config, nrfx_gpiote_evt_handler_t evt_handler)
+{
+    if (pin >= SIM_GPIO_PIN_COUNT) {
+        return NRFX_ERROR_INVALID_PARAM;
+    }
+
+    if (m_in[pin].configured) {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+
+    m_in[pin] = (gpiote_in_t){
+        .configured = true,
+        .sense      = p_config->sense,
+        .handler    = evt_handler,
+    };
+
+    return NRFX_SUCCESS;
+}
+
+void nrfx_gpiote_in_uninit(nrfx_gpiote_pin_t pin)
+{
+    if (pin < SIM_GPIO_PIN_COUNT) {
+        m_in[pin] = (gpiote_in_t){0};
+    }
+}
+
+void nrfx_gpiote_in_event_enable(nrfx_gpiote_pin_t pin, bool int_enable)
+{
+    // Without the interrupt the event only feeds PPI, which is not simulated.
+    if ((pin < SIM_GPIO_PIN_COUNT) && m_in[pin].configured) {
+        m_in[pin].enabled = int_enable;
+    }
+}
+
+void nrfx_gpiote_in_event_disable(nrfx_gpiote_pin_t pin)
+{
+    if (pin < SIM_GPIO_PIN_COUNT) {
+        m_in[pin].enabled   = false;
+        m_in[pin].triggered = false;
+    }
+}
+
+bool nrfx_gpiote_in_is_set(nrfx_gpiote_pin_t pin) { return nrf_gpio_pin_read(pin) != 0; }
+
+uint32_t nrfx_gpiote_in_event_addr_get(nrfx_gpiote_pin_t pin) { return 0; }
@@ -0,0 +1,31 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include "sdk_config.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// GPIO statistics.
+typedef struct {
+    uint32_t edges;  // Input level changes.
+    uint32_t events; // Edges matching an enabled GPIOTE IN event.
+} sim_gpio_stats_t;
+
+/**@brief       Drive an input pin from a simulated device, an enabled GPIOTE IN event pends the GPIOTE interrupt.
+ *
+ * @param[in]   pin       -   Pin.
+ * @param[in]   level     -   Input level.
+ */
+void sim_gpio_input_set(uint32_t pin, bool level);
+
+/** Output level of the pin, as driven by the firmware. */
+bool sim_gpio_output_get(uint32_t pin);
+
+/** GPIO statistics. */
+void sim_gpio_stats_get(sim_gpio_stats_t *p_stats);
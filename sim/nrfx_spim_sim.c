@@ -0,0 +1,194 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "nrfx_spim_sim.h"
+
+#include "app_util.h"
+#include "lsm303agr_sim.h"
+#include "lsm303agr_xl_sim.h"
+#include "nrf_gpio_sim.h"
+#include "nrfx_spim.h"
+#include "sim.h"
+
+#include <string.h>
+
+#define SPI_READ 0x80     // Command byte MSB, 1 for read.
+#define BITS_PER_BYTE 8   // Data bits, SDIO has no acknowledge.
+#define BUS_FLOATING 0xFF // Data phase without a device driving SDIO.
+
+NRF_SPIM_Type sim_spim2 = {.index = 2};
+
+// Device on the bus.
+typedef enum {
+    DEVICE_NONE, // No chip select or both are low.
+    DEVICE_XL,   // Accelerometer.
+    DEVICE_MAG,  // Magnetometer.
+} device_t;
+
+static nrfx_spim_evt_handler_t m_handler   = NULL;
+static void                   *mp_context  = NULL;
+static uint32_t                m_frequency = 8000000;   // SCK frequency [Hz].
+static uint64_t                m_done_us   = SIM_NEVER; // Completion of the transfer on the bus.
+static nrfx_spim_evt_t         m_event;                 // Event of the transfer on the bus.
+static uint32_t                m_cs_xl_pin;
+static uint32_t                m_cs_mag_pin;
+static device_t                m_read_device = DEVICE_NONE; // Device of the read command awaiting its data phase.
+static uint8_t                 m_read_cmd;                  // Read command awaiting its data phase.
+static sim_spim_stats_t        m_stats;
+
+static void spim_irq_handler(void)
+{
+    // Bus is free before the handler queues the next transfer.
+    nrfx_spim_evt_t event = m_event;
+
+    m_handler(&event, mp_context);
+}
+
+static sim_irq_t m_spim_irq = {.handler = spim_irq_handler};
+
+static uint64_t spim_next_us(void) { return m_done_us; }
+
+static void spim_run(uint64_t now_us)
+{
+    m_done_us = SIM_NEVER;
+    sim_irq_pend(&m_spim_irq);
+}
+
+static const sim_source_t m_source = {
+    .next_us = spim_next_us,
+    .run     = spim_run,
+};
+
+/** Device selected by its chip select, none unless exactly one is low. */
+static device_t device_selected(void)
+{
+    bool xl  = !sim_gpio_output_get(m_cs_xl_pin);
+    bool mag = !sim_gpio_output_get(m_cs_mag_pin);
+
+    if (xl == mag) {
+        return DEVICE_NONE;
+    }
+
+    return xl ? DEVICE_XL : DEVICE_MAG;
+}
+
+/**@brief       Serve a transfer, a TX transfer starts with the command byte, an RX transfer is the data phase of a read.
+ *
+ * @param[in]   p_xfer_desc   -   Transfer descriptor.
+ *
+ * @retval  False if no device served the transfer.
+ */
+static bool device_xfer(nrfx_spim_xfer_desc_t const *p_xfer_desc)
+{
+    device_t device = device_selected();
+
+    if (p_xfer_desc->tx_length > 0) {
+        uint8_t cmd = p_xfer_desc->p_tx_buffer[0];
+
+        m_read_device = DEVICE_NONE;
+
+        if ((device == DEVICE_NONE) || ((cmd & SPI_READ) && (p_xfer_desc->tx_length != 1))) {
+            return false;
+        }
+
+        // SDIO is turned around after a read command, the data phase follows with chip select held low.
+        if (cmd & SPI_READ) {
+            m_read_device = device;
+            m_read_cmd    = cmd;
+        } else if (device == DEVICE_XL) {
+            lsm303agr_xl_sim_spi_write(cmd, &p_xfer_desc->p_tx_buffer[1], p_xfer_desc->tx_length - 1);
+        } else {
+            lsm303agr_sim_spi_write(cmd, &p_xfer_desc->p_tx_buffer[1], p_xfer_desc->tx_length - 1);
+        }
+    }
+
+    if (p_xfer_desc->rx_length > 0) {
+        device_t read_device = m_read_device;
+
+        m_read_device = DEVICE_NONE;
+
+        if ((read_device == DEVICE_NONE) || (read_device != device)) {
+            memset(p_xfer_desc->p_rx_buffer, BUS_FLOATING, p_xfer_desc->rx_length);
+            return false;
+        }
+
+        if (device == DEVICE_XL) {
+            lsm303agr_xl_sim_spi_read(m_read_cmd, p_xfer_desc->p_rx_buffer, p_xfer_desc->rx_length);
+        } else {
+            lsm303agr_sim_spi_read(m_read_cmd, p_xfer_desc->p_rx_buffer, p_xfer_desc->rx_length);
+        }
+    }
+
+    return true;
+}
+
+nrfx_err_t nrfx_spim_init(nrfx_spim_t const *p_instance, nrfx_spim_config_t const *p_config, nrfx_spim_evt_handler_t handler,
+                          void *p_context)
+{
+    if (handler == NULL) {
+        return NRFX_ERROR_NOT_SUPPORTED;
+    }
+
+    switch (p_config->frequency) {
+    case NRF_SPIM_FREQ_1M:
+        m_frequency = 1000000;
+        break;
+    case NRF_SPIM_FREQ_2M:
+        m_frequency = 2000000;
+        break;
+    case NRF_SPIM_FREQ_4M:
+        m_frequency = 4000000;
+        break;
+    default:
+        m_frequency = 8000000;
+        break;
+    }
+
+    m_handler           = handler;
+    mp_context          = p_context;
+    m_spim_irq.priority = p_config->irq_priority;
+
+    sim_irq_register(&m_spim_irq);
+    sim_source_register(&m_source);
+
+    return NRFX_SUCCESS;
+}
+
+void nrfx_spim_uninit(nrfx_spim_t const *p_instance) {}
+
+nrfx_err_t nrfx_spim_xfer(nrfx_spim_t const *p_instance, nrfx_spim_xfer_desc_t const *p_xfer_desc, uint32_t flags)
+{
+    if ((m_done_us != SIM_NEVER) || m_spim_irq.pending) {
+        return NRFX_ERROR_BUSY;
+    }
+
+    // Held and repeated transfers are driven by PPI on the target, not simulated.
+    if (flags != 0) {
+        return NRFX_ERROR_NOT_SUPPORTED;
+    }
+
+    // The device serves the transfer when it starts, completion is reported after the bus time.
+    uint32_t bytes = MAX(p_xfer_desc->tx_length, p_xfer_desc->rx_length);
+    uint32_t bits  = bytes * BITS_PER_BYTE;
+
+    m_stats.errors += device_xfer(p_xfer_desc) ? 0 : 1;
+    m_stats.transfers++;
+    m_stats.bytes += bytes;
+
+    m_event.type      = NRFX_SPIM_EVENT_DONE;
+    m_event.xfer_desc = *p_xfer_desc;
+    m_done_us         = sim_now_us() + (((uint64_t)bits * 1000000 + m_frequency - 1) / m_frequency);
+
+    return NRFX_SUCCESS;
+}
+
+void sim_spim_cs_set(uint32_t cs_xl_pin, uint32_t cs_mag_pin)
+{
+    m_cs_xl_pin  = cs_xl_pin;
+    m_cs_mag_pin = cs_mag_pin;
+}
+
+void sim_spim_stats_get(sim_spim_stats_t *p_stats) { *p_stats = m_stats; }
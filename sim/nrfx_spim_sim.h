@@ -0,0 +1,26 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// SPIM bus statistics.
+typedef struct {
+    uint32_t transfers; // Transfers started.
+    uint32_t errors;    // Transfers without exactly one device selected, or a data phase without a read command.
+    uint32_t bytes;     // Bytes on the bus, command bytes included.
+} sim_spim_stats_t;
+
+/**@brief       Connect the devices to the bus, a transfer is served by the device whose chip select is low.
+ *
+ * @param[in]   cs_xl_pin  -   Accelerometer chip select (CS_A) pin.
+ * @param[in]   cs_mag_pin -   Magnetometer chip select (CS_M) pin.
+ */
+void sim_spim_cs_set(uint32_t cs_xl_pin, uint32_t cs_mag_pin);
+
+/** SPIM bus statistics. */
+void sim_spim_stats_get(sim_spim_stats_t *p_stats);
@@ -0,0 +1,153 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "nrfx_twim_sim.h"
+
+#include "lsm303agr_sim.h"
+#include "nrfx_twim.h"
+#include "sim.h"
+
+#define BITS_PER_BYTE 9 // Data bits and the acknowledge.
+#define BITS_START 1    // START or repeated START.
+#define BITS_STOP 1     // STOP.
+
+NRF_TWIM_Type sim_twim0 = {.index = 0};
+NRF_TWIM_Type sim_twim1 = {.index = 1};
+
+static nrfx_twim_evt_handler_t m_handler   = NULL;
+static void                   *mp_context  = NULL;
+static uint32_t                m_frequency = 400000;  // SCL frequency [Hz].
+static bool                    m_enabled   = false;
+static uint64_t                m_done_us   = SIM_NEVER; // Completion of the transfer on the bus.
+static nrfx_twim_evt_t         m_event;                 // Event of the transfer on the bus.
+static sim_twim_stats_t        m_stats;
+
+static void twim_irq_handler(void)
+{
+    // Bus is free before the handler queues the next transfer.
+    nrfx_twim_evt_t event = m_event;
+
+    m_handler(&event, mp_context);
+}
+
+static sim_irq_t m_twim_irq = {.handler = twim_irq_handler};
+
+static uint64_t twim_next_us(void) { return m_done_us; }
+
+static void twim_run(uint64_t now_us)
+{
+    // STOPPED, the driver is busy until its interrupt handler ran.
+    m_done_us = SIM_NEVER;
+    sim_irq_pend(&m_twim_irq);
+}
+
+static const sim_source_t m_source = {
+    .next_us = twim_next_us,
+    .run     = twim_run,
+};
+
+/** Bus time of the bits at the SCL frequency [us]. */
+static uint64_t bus_time_us(uint32_t bits) { return ((uint64_t)bits * 1000000 + m_frequency - 1) / m_frequency; }
+
+nrfx_err_t nrfx_twim_init(nrfx_twim_t const *p_instance, nrfx_twim_config_t const *p_config, nrfx_twim_evt_handler_t event_handler,
+                          void *p_context)
+{
+    if (event_handler == NULL) {
+        return NRFX_ERROR_NOT_SUPPORTED;
+    }
+
+    switch (p_config->frequency) {
+    case NRF_TWIM_FREQ_100K:
+        m_frequency = 100000;
+        break;
+    case NRF_TWIM_FREQ_250K:
+        m_frequency = 250000;
+        break;
+    default:
+        m_frequency = 400000;
+        break;
+    }
+
+    m_handler           = event_handler;
+    mp_context          = p_context;
+    m_twim_irq.priority = p_config->interrupt_priority;
+
+    sim_irq_register(&m_twim_irq);
+    sim_source_register(&m_source);
+
+    return NRFX_SUCCESS;
+}
+
+void nrfx_twim_uninit(nrfx_twim_t const *p_instance) { m_enabled = false; }
+
+void nrfx_twim_enable(nrfx_twim_t const *p_instance) { m_enabled = true; }
+
+void nrfx_twim_disable(nrfx_twim_t const *p_instance) { m_enabled = false; }
+
+bool nrfx_twim_is_busy(nrfx_twim_t const *p_instance) { return (m_done_us != SIM_NEVER) || m_twim_irq.pending; }
+
+nrfx_err_t nrfx_twim_xfer(nrfx_twim_t const *p_instance, nrfx_twim_xfer_desc_t const *p_xfer_desc, uint32_t flags)
+{
+    if (!m_enabled) {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+
+    if (nrfx_twim_is_busy(p_instance)) {
+        m_stats.busy++;
+        return NRFX_ERROR_BUSY;
+    }
+
+    // Chained, held and repeated transfers are driven by PPI on the target, not simulated.
+    if ((flags != 0) || (p_xfer_desc->type == NRFX_TWIM_XFER_TXTX)) {
+        return NRFX_ERROR_NOT_SUPPORTED;
+    }
+
+    uint8_t  addr  = p_xfer_desc->address;
+    uint32_t bytes = 1; // Address.
+    uint32_t bits  = BITS_START + BITS_STOP;
+    bool     ack   = true;
+
+    // The device serves the transfer when it starts, completion is reported after the bus time.
+    switch (p_xfer_desc->type) {
+    case NRFX_TWIM_XFER_TX:
+        ack = lsm303agr_sim_i2c_write(addr, p_xfer_desc->p_primary_buf, p_xfer_desc->primary_length);
+        bytes += ack ? p_xfer_desc->primary_length : 0;
+        break;
+
+    case NRFX_TWIM_XFER_RX:
+        ack = lsm303agr_sim_i2c_read(addr, p_xfer_desc->p_primary_buf, p_xfer_desc->primary_length);
+        bytes += ack ? p_xfer_desc->primary_length : 0;
+        break;
+
+    case NRFX_TWIM_XFER_TXRX:
+        ack = lsm303agr_sim_i2c_write(addr, p_xfer_desc->p_primary_buf, p_xfer_desc->primary_length) &&
+              lsm303agr_sim_i2c_read(addr, p_xfer_desc->p_secondary_buf, p_xfer_desc->secondary_length);
+        if (ack) {
+            // Repeated START and address.
+            bytes += p_xfer_desc->primary_length + 1 + p_xfer_desc->secondary_length;
+            bits += BITS_START;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    bits += bytes * BITS_PER_BYTE;
+
+    m_event.type      = ack ? NRFX_TWIM_EVT_DONE : NRFX_TWIM_EVT_ADDRESS_NACK;
+    m_event.xfer_desc = *p_xfer_desc;
+    m_done_us         = sim_now_us() + bus_time_us(bits);
+
+    m_stats.transfers++;
+    m_stats.nacks += ack ? 0 : 1;
+    m_stats.bytes += bytes;
+    m_stats.bus_us += bus_time_us(bits);
+
+    return NRFX_SUCCESS;
+}
+
+void sim_twim_stats_get(sim_twim_stats_t *p_stats) { *p_stats = m_stats; }
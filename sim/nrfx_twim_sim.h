@@ -0,0 +1,21 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// TWIM bus statistics.
+typedef struct {
+    uint32_t transfers; // Transfers started.
+    uint32_t nacks;     // Transfers not acknowledged.
+    uint32_t busy;      // Transfers rejected while the bus was busy.
+    uint32_t bytes;     // Bytes on the bus, addresses included.
+    uint64_t bus_us;    // Time the bus was busy [us].
+} sim_twim_stats_t;
+
+/** TWIM bus statistics. */
+void sim_twim_stats_get(sim_twim_stats_t *p_stats);
@@ -0,0 +1,157 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#include "sim.h"
+
+#include "nrfx_log.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const sim_source_t *mp_sources[SIM_MAX_SOURCES];
+static uint8_t             m_source_count = 0;
+
+static sim_irq_t *mp_irqs[SIM_MAX_IRQS];
+static uint8_t    m_irq_count = 0;
+
+static uint64_t m_now_us   = 0;
+static uint8_t  m_priority = SIM_PRIORITY_THREAD; // Priority of the running context.
+
+/**@brief       Run pended interrupts that preempt the running context, highest priority first.
+ *
+ * @retval  True if a handler ran.
+ */
+static bool irq_dispatch(void)
+{
+    bool ran = false;
+
+    while (true) {
+        sim_irq_t *p_irq = NULL;
+
+        for (uint8_t i = 0; i < m_irq_count; i++) {
+            if (mp_irqs[i]->pending && (mp_irqs[i]->priority < m_priority) &&
+                ((p_irq == NULL) || (mp_irqs[i]->priority < p_irq->priority))) {
+                p_irq = mp_irqs[i];
+            }
+        }
+
+        if (p_irq == NULL) {
+            return ran;
+        }
+
+        uint8_t preempted = m_priority;
+
+        p_irq->pending = false;
+        m_priority     = p_irq->priority;
+        p_irq->handler();
+        m_priority = preempted;
+        ran        = true;
+    }
+}
+
+void sim_source_register(const sim_source_t *p_source)
+{
+    if (m_source_count == SIM_MAX_SOURCES) {
+        fprintf(stderr, "sim: too many sources\n");
+        exit(EXIT_FAILURE);
+    }
+
+    mp_sources[m_source_count++] = p_source;
+}
+
+void sim_irq_register(sim_irq_t *p_irq)
+{
+    if (m_irq_count == SIM_MAX_IRQS) {
+        fprintf(stderr, "sim: too many interrupts\n");
+        exit(EXIT_FAILURE);
+    }
+
+    mp_irqs[m_irq_count++] = p_irq;
+}
+
+void sim_irq_pend(sim_irq_t *p_irq) { p_irq->pending = true; }
+
+uint64_t sim_now_us(void) { return m_now_us; }
+
+bool sim_step(uint64_t limit_us)
+{
+    const sim_source_t *p_next = NULL;
+    uint64_t            next   = SIM_NEVER;
+
+    for (uint8_t i = 0; i < m_source_count; i++) {
+        uint64_t t = mp_sources[i]->next_us();
+
+        if (t < next) {
+            next   = t;
+            p_next = mp_sources[i];
+        }
+    }
+
+    if ((p_next == NULL) || (next > limit_us)) {
+        if (limit_us != SIM_NEVER) {
+            m_now_us = limit_us;
+        }
+        return false;
+    }
+
+    // Time never runs backwards, an overdue event runs now.
+    if (next > m_now_us) {
+        m_now_us = next;
+    }
+
+    p_next->run(m_now_us);
+    irq_dispatch();
+
+    return true;
+}
+
+void sim_delay_us(uint64_t us)
+{
+    uint64_t target = m_now_us + us;
+
+    while (sim_step(target)) {
+    }
+}
+
+void sim_wfe(void)
+{
+    if (irq_dispatch()) {
+        return;
+    }
+
+    // Nothing will ever wake the core, the firmware would hang here.
+    if (!sim_step(SIM_NEVER)) {
+        fprintf(stderr, "sim: WFE without any pending event at %llu us\n", (unsigned long long)m_now_us);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void sim_log(const char *p_module, const char *p_level, const char *p_format, ...)
+{
+    va_list args;
+
+    fprintf(stderr, "[%10.3f ms] <%s> %s: ", m_now_us / 1000.0, p_level, p_module);
+
+    va_start(args, p_format);
+    vfprintf(stderr, p_format, args);
+    va_end(args);
+
+    fputc('\n', stderr);
+}
+
+void sim_log_hexdump(const char *p_module, const void *p_data, uint32_t len)
+{
+    const uint8_t *p_bytes = p_data;
+
+    fprintf(stderr, "[%10.3f ms] <info> %s:", m_now_us / 1000.0, p_module);
+
+    for (uint32_t i = 0; i < len; i++) {
+        fprintf(stderr, " %02x", p_bytes[i]);
+    }
+
+    fputc('\n', stderr);
+}
@@ -0,0 +1,67 @@
+/**
+ * Copyright (c) 2024, Tomer Hanochi.
+ *
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Virtual time host simulation core.
+ *
+ * Time only advances when the firmware waits (__WFE, nrf_delay) or the harness steps it, and it jumps straight
+ * to the next event of a registered source. Interrupts are pended by the sources and run at those wait points,
+ * a handler only preempts code of a lower priority, as the NVIC would.
+ */
+
+/** No event is scheduled. */
+#define SIM_NEVER UINT64_MAX
+
+/** Priority of thread mode, below any interrupt. */
+#define SIM_PRIORITY_THREAD 8
+
+/** Maximal number of event sources and interrupts. */
+#define SIM_MAX_SOURCES 8
+#define SIM_MAX_IRQS 8
+
+// Source of timed events, a peripheral model.
+typedef struct {
+    uint64_t (*next_us)(void);      // Time of the next event, SIM_NEVER if none.
+    void (*run)(uint64_t now_us);   // Process the events due, may pend interrupts.
+} sim_source_t;
+
+// Simulated interrupt.
+typedef struct {
+    void (*handler)(void); // Interrupt handler.
+    uint8_t priority;      // Lower value preempts, as APP_IRQ_PRIORITY_*.
+    bool    pending;       // Set by sim_irq_pend(), cleared when the handler runs.
+} sim_irq_t;
+
+/** Register a peripheral model. */
+void sim_source_register(const sim_source_t *p_source);
+
+/** Register an interrupt. */
+void sim_irq_register(sim_irq_t *p_irq);
+
+/** Pend an interrupt, it runs at the next wait point of a lower priority context. */
+void sim_irq_pend(sim_irq_t *p_irq);
+
+/** Current virtual time [us]. */
+uint64_t sim_now_us(void);
+
+/**@brief       Advance to the next event not later than the limit and run it, pended interrupts run after it.
+ *
+ * @param[in]   limit_us  -   Latest time to advance to.
+ *
+ * @retval  True if an event was run, false if time advanced to the limit.
+ */
+bool sim_step(uint64_t limit_us);
+
+/** Busy wait of nrf_delay, events and interrupts run meanwhile. */
+void sim_delay_us(uint64_t us);
+
+/** __WFE, run pended interrupts or advance to the next event, the harness loop decides when to stop. */
+void sim_wfe(void);
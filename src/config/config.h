@@ -12,4 +12,18 @@
 #define TWIM_INST 0    //!< TWIM interface used as a master
 #define TWIM_SCL_PIN 3 //!< Master SCL pin.
 #define TWIM_SDA_PIN 4 //!< Master SDA pin.
-#define MAG_INT_PIN 5  //!< Magnetometer interrupt pin.
\ No newline at end of file
+#define MAG_INT_PIN 5  //!< Magnetometer interrupt pin.
+
+/* LSM303AGR bus selection */
+#define MAG_BUS_SPIM 0 //!< 1 for 3-wire SPI, 0 for I2C.
+
+/* SPIM Configuration */
+#define SPIM_INST 2       //!< SPIM interface used as a master
+#define SPIM_SCK_PIN 3    //!< SPC, shared with the SCL pin.
+#define SPIM_MISO_PIN 4   //!< SDIO, shared with the SDA pin.
+#define SPIM_MOSI_PIN 6   //!< Connected to SDIO through a series resistor.
+#define SPIM_CS_XL_PIN 7  //!< Accelerometer chip select.
+#define SPIM_CS_MAG_PIN 8 //!< Magnetometer chip select.
+
+/* Power measurement */
+#define IDLE_CURRENT_MODE 0 //!< 1 to keep the magnetometer idle and the LEDs off, only the RTC wakes the core.
@@ -39,10 +39,15 @@
  */
 
 #include "app_error.h"
+#include "app_scheduler.h"
 #include "app_timer.h"
 #include "app_util_platform.h"
 #include "bsp.h"
 #include "config.h"
+#include "magnetometer/lsm303agr.h"
+#include "magnetometer/lsm303agr_bus_trace.h"
+#include "magnetometer/lsm303agr_spim.h"
+#include "magnetometer/lsm303agr_twim.h"
 #include "magnetometer/magnetometer.h"
 #include "nrf.h"
 #include "nrf_drv_clock.h"
@@ -50,19 +55,36 @@
 #include "nrf_log.h"
 #include "nrf_log_ctrl.h"
 #include "nrf_log_default_backends.h"
+#include "nrf_pwr_mgmt.h"
 #include "nrfx_gpiote.h"
+#include "nrfx_spim.h"
 #include "nrfx_twim.h"
+#include "profile/profile.h"
+#include "trace/trace.h"
 
 #include <ctype.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 
+#define SCHED_MAX_EVENT_DATA_SIZE 0 // Magnetometer events are held in its own queue.
+#define SCHED_QUEUE_SIZE 8
+
+#if MAG_BUS_SPIM
+static const nrfx_spim_t m_spi_master = NRFX_SPIM_INSTANCE(SPIM_INST);
+#else
 static const nrfx_twim_t m_twi_master = NRFX_TWIM_INSTANCE(TWIM_INST);
+#endif
+
+static uint32_t m_magnet_detections = 0; // Number of magnet detections since boot.
 
-const nrfx_twim_t *p_twi_master = &m_twi_master;
+#if PROFILE_ENABLED
+static volatile bool m_profile_dump = false; // Set from the debugger to log the profile statistics, e.g. "set var m_profile_dump = 1".
+#endif
 
-static void magnetometer_evt_handler(const magnetometer_event_t event);
+static void magnetometer_led_handler(const magnetometer_evt_t *p_evt);
+static void magnetometer_log_handler(const magnetometer_evt_t *p_evt);
+static void magnetometer_counter_handler(const magnetometer_evt_t *p_evt);
 
 /**
  * @brief Initialize common modules and services.
@@ -76,20 +98,73 @@ static void modules_init(void)
     APP_ERROR_CHECK(NRF_LOG_INIT(NULL));
     NRF_LOG_DEFAULT_BACKENDS_INIT();
 
+    // Initialize binary trace, decoded on the host by tools/trace_decode.py.
+    trace_init();
+
+    // Start the cycle counter, nothing if profiling is disabled.
+    profile_init();
+
+    // Bus transactions before a soft reset are kept, dump them before new ones overwrite them.
+    if (lsm303agr_bus_trace_init()) {
+        lsm303agr_bus_trace_dump();
+    }
+
     // Initialize clock.
     err_code = nrf_drv_clock_init();
     APP_ERROR_CHECK(err_code);
 
     nrf_drv_clock_lfclk_request(NULL);
 
+    // Initialize scheduler, interrupt handlers defer their work to the main loop.
+    APP_SCHED_INIT(SCHED_MAX_EVENT_DATA_SIZE, SCHED_QUEUE_SIZE);
+
     // Initialize app timer.
     err_code = app_timer_init();
     APP_ERROR_CHECK(err_code);
 
+    // Initialize power management, the main loop sleeps between events.
+    err_code = nrf_pwr_mgmt_init();
+    APP_ERROR_CHECK(err_code);
+
     // Initialize bsp.
     bsp_board_init(BSP_INIT_LEDS);
 }
 
+#if MAG_BUS_SPIM
+/**
+ * @brief Initialize the master SPI.
+ *
+ * Function used to initialize the 3-wire SPI interface of the LSM303AGR.
+ *
+ * @return NRF_SUCCESS or the reason of failure.
+ */
+static ret_code_t spi_master_init(void)
+{
+    ret_code_t         ret;
+    nrfx_spim_config_t config = NRFX_SPIM_DEFAULT_CONFIG;
+
+    // Chip select of each device is driven by the lsm303agr SPIM backend.
+    config.sck_pin      = SPIM_SCK_PIN;
+    config.mosi_pin     = SPIM_MOSI_PIN;
+    config.miso_pin     = SPIM_MISO_PIN;
+    config.ss_pin       = NRFX_SPIM_PIN_NOT_USED;
+    config.frequency    = NRF_SPIM_FREQ_8M;
+    config.mode         = NRF_SPIM_MODE_3;
+    config.irq_priority = APP_IRQ_PRIORITY_HIGH;
+    config.orc          = 0xFF;
+
+    // Non-blocking mode, transfers are completed from the SPIM interrupt.
+    ret = nrfx_spim_init(&m_spi_master, &config, lsm303agr_spim_event_handler, NULL);
+    APP_ERROR_CHECK(ret);
+
+    // Select the bus for the lsm303agr driver.
+    if (!lsm303agr_init(lsm303agr_spim_bus(&m_spi_master, SPIM_CS_XL_PIN, SPIM_CS_MAG_PIN))) {
+        ret = NRF_ERROR_INTERNAL;
+    }
+
+    return ret;
+}
+#else
 /**
  * @brief Initialize the master TWI.
  *
@@ -106,13 +181,20 @@ static ret_code_t twi_master_init(void)
                                        .interrupt_priority = APP_IRQ_PRIORITY_HIGH,
                                        .hold_bus_uninit    = false};
 
-    ret = nrfx_twim_init(&m_twi_master, &config, NULL, NULL);
+    // Non-blocking mode, transfers are completed from the TWIM interrupt.
+    ret = nrfx_twim_init(&m_twi_master, &config, lsm303agr_twim_event_handler, NULL);
     APP_ERROR_CHECK(ret);
 
     nrfx_twim_enable(&m_twi_master);
 
+    // Select the bus for the lsm303agr driver.
+    if (!lsm303agr_init(lsm303agr_twim_bus(&m_twi_master))) {
+        ret = NRF_ERROR_INTERNAL;
+    }
+
     return ret;
 }
+#endif
 
 void dummy_event_handler(nrfx_gpiote_pin_t pin, nrf_gpiote_polarity_t action) {}
 
@@ -124,6 +206,8 @@ static void gpio_init(void)
     err_code = nrfx_gpiote_init();
     APP_ERROR_CHECK(err_code);
 
+#if !MAG_BUS_SPIM && !IDLE_CURRENT_MODE
+    // SPIM drives SCK, the bus pins are sensed on I2C only, an idle current measurement leaves them unconfigured.
     in_config      = (nrfx_gpiote_in_config_t)NRFX_GPIOTE_CONFIG_IN_SENSE_TOGGLE(true);
     in_config.pull = NRF_GPIO_PIN_PULLUP;
     err_code       = nrfx_gpiote_in_init(TWIM_SCL_PIN, &in_config, dummy_event_handler);
@@ -135,8 +219,10 @@ static void gpio_init(void)
     err_code       = nrfx_gpiote_in_init(TWIM_SDA_PIN, &in_config, dummy_event_handler);
     // nrfx_gpiote_in_event_enable(TWIM_SDA_PIN, false);
     APP_ERROR_CHECK(err_code);
+#endif
 
-    in_config      = (nrfx_gpiote_in_config_t)NRFX_GPIOTE_CONFIG_IN_SENSE_TOGGLE(true);
+    // An idle current measurement senses MAG_INT_PIN through PORT, no GPIOTE channel is held.
+    in_config      = (nrfx_gpiote_in_config_t)NRFX_GPIOTE_CONFIG_IN_SENSE_TOGGLE(!IDLE_CURRENT_MODE);
     in_config.pull = NRF_GPIO_PIN_NOPULL;
     err_code       = nrfx_gpiote_in_init(MAG_INT_PIN, &in_config, magnetometer_gpiote_event_handler);
     // nrfx_gpiote_in_event_enable(MAG_INT_PIN, true);
@@ -151,14 +237,27 @@ void peripherals_init(void)
 {
     ret_code_t err_code;
 
+#if MAG_BUS_SPIM
+    /* Initializing SPI master interface. */
+    spi_master_init();
+#else
     /* Initializing TWI master interface. */
     twi_master_init();
+#endif
 
     /* Initializing GPIOs. */
     gpio_init();
 
-    // Initialize lsm303agr.
-    magnetometer_init(magnetometer_evt_handler);
+    // Initialize lsm303agr, fails without a bus if the bus initialization failed.
+    if (!magnetometer_init()) {
+        NRF_LOG_ERROR("LSM303AGR is not found.");
+    }
+
+    // Subscribe to magnetometer events.
+    magnetometer_register(magnetometer_led_handler,
+                          MAGNETOMETER_EVT_MASK(MAGNETOMETER_EVENT_MAGNET_DETECTED) | MAGNETOMETER_EVT_MASK(MAGNETOMETER_EVENT_MAGNET_NOT_DETECTED));
+    magnetometer_register(magnetometer_log_handler, MAGNETOMETER_EVT_MASK_ALL);
+    magnetometer_register(magnetometer_counter_handler, MAGNETOMETER_EVT_MASK(MAGNETOMETER_EVENT_MAGNET_DETECTED));
 }
 
 /**
@@ -174,33 +273,94 @@ int main(void)
 
     NRF_LOG_INFO("Starting..");
 
+#if IDLE_CURRENT_MODE
+    // Magnetometer stays in idle mode, detach the debugger before measuring, RTT keeps the debug domain powered.
+    bsp_board_leds_off();
+    NRF_LOG_INFO("Idle current mode.");
+#else
     // Start magnetometer measurements.
     magnetometer_start();
+#endif
 
     /* Main loop */
     while (1) {
-        UNUSED_RETURN_VALUE(NRF_LOG_PROCESS());
+        app_sched_execute();
+
+#if PROFILE_ENABLED
+        // Dump requested from the debugger, halting the core wakes it from sleep.
+        if (m_profile_dump) {
+            m_profile_dump = false;
+            profile_dump();
+        }
+#endif
+
+        // Sleep in System ON once the log backlog is drained, interrupts wake the core.
+        if (!NRF_LOG_PROCESS()) {
+            nrf_pwr_mgmt_run();
+        }
     }
 }
 
-static void magnetometer_evt_handler(const magnetometer_event_t event)
+static void magnetometer_led_handler(const magnetometer_evt_t *p_evt)
 {
-    switch (event) {
+    switch (p_evt->type) {
     case MAGNETOMETER_EVENT_MAGNET_DETECTED:
-        NRF_LOG_INFO("%s MAGNETOMETER_EVENT_MAGNET_DETECTED", __func__);
-
         // Magnet detected, turn the LED on.
         bsp_board_led_on(0);
         bsp_board_led_off(2);
         break;
     case MAGNETOMETER_EVENT_MAGNET_NOT_DETECTED:
-        NRF_LOG_INFO("%s MAGNETOMETER_EVENT_MAGNET_NOT_DETECTED", __func__);
-
         // Magnet not detected, turn the LED off.
         bsp_board_led_off(0);
         bsp_board_led_on(2);
         break;
     default:
-        NRF_LOG_WARNING("%s Unknown magnetometer event %d", __func__, event);
+        break;
     }
-}
\ No newline at end of file
+}
+
+static void log_axes(uint8_t axes)
+{
+    // Magnet orientation, the positive or negative side of each axis.
+    NRF_LOG_INFO("Axes X: %c%c, Y: %c%c, Z: %c%c", (axes & MAGNETOMETER_AXIS_P_X) ? '+' : ' ', (axes & MAGNETOMETER_AXIS_N_X) ? '-' : ' ',
+                 (axes & MAGNETOMETER_AXIS_P_Y) ? '+' : ' ', (axes & MAGNETOMETER_AXIS_N_Y) ? '-' : ' ',
+                 (axes & MAGNETOMETER_AXIS_P_Z) ? '+' : ' ', (axes & MAGNETOMETER_AXIS_N_Z) ? '-' : ' ');
+}
+
+static void magnetometer_log_handler(const magnetometer_evt_t *p_evt)
+{
+    switch (p_evt->type) {
+    case MAGNETOMETER_EVENT_START:
+        NRF_LOG_INFO("%s MAGNETOMETER_EVENT_START at %d", __func__, p_evt->timestamp);
+        break;
+    case MAGNETOMETER_EVENT_STOP:
+        NRF_LOG_INFO("%s MAGNETOMETER_EVENT_STOP at %d", __func__, p_evt->timestamp);
+        break;
+    case MAGNETOMETER_EVENT_MAGNET_DETECTED:
+        NRF_LOG_INFO("%s MAGNETOMETER_EVENT_MAGNET_DETECTED at %d", __func__, p_evt->timestamp);
+        log_axes(p_evt->axes);
+        break;
+    case MAGNETOMETER_EVENT_MAGNET_NOT_DETECTED:
+        NRF_LOG_INFO("%s MAGNETOMETER_EVENT_MAGNET_NOT_DETECTED at %d", __func__, p_evt->timestamp);
+        log_axes(p_evt->axes);
+        break;
+    case MAGNETOMETER_EVENT_CALIBRATED:
+        NRF_LOG_INFO("%s MAGNETOMETER_EVENT_CALIBRATED offset x: %d, y: %d, z: %d", __func__, p_evt->field.x, p_evt->field.y,
+                     p_evt->field.z);
+        break;
+    case MAGNETOMETER_EVENT_CALIBRATION_FAILED:
+        NRF_LOG_WARNING("%s MAGNETOMETER_EVENT_CALIBRATION_FAILED", __func__);
+        break;
+    case MAGNETOMETER_EVENT_SAMPLE:
+        NRF_LOG_DEBUG("%s MAGNETOMETER_EVENT_SAMPLE x: %d, y: %d, z: %d", __func__, p_evt->field.x, p_evt->field.y, p_evt->field.z);
+        break;
+    default:
+        NRF_LOG_WARNING("%s Unknown magnetometer event %d", __func__, p_evt->type);
+    }
+}
+
+static void magnetometer_counter_handler(const magnetometer_evt_t *p_evt)
+{
+    // Filtered to detections only.
+    m_magnet_detections++;
+}
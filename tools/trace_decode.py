@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2024, Tomer Hanochi.
+#
+# All rights reserved.
+#
+"""Decode the binary trace of drivers/trace/trace.c.
+
+Capture RTT up channel 1 to a file, for example:
+
+    JLinkRTTLogger -Device NRF52840_XXAA -If SWD -Speed 4000 -RTTChannel 1 trace.bin
+
+then decode it:
+
+    python3 tools/trace_decode.py trace.bin
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+HEADER_SIZE = 5  # ID, payload size and 24-bit timestamp.
+DATA_FLAG = 0x80
+TIMESTAMP_WRAP = 1 << 24
+PREEMPT_TICKS = 1 << 12  # Largest step back of a record written by a preempting interrupt.
+
+DEFAULT_IDS = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "drivers", "trace", "trace_ids.h")
+DEFAULT_SDK_CONFIG = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "config", "sdk_config.h")
+RTC_CLOCK = 32768
+DEFAULT_FREQ = 16384  # APP_TIMER_CONFIG_RTC_FREQUENCY 1 of src/config/sdk_config.h.
+
+
+def load_ids(path):
+    """Return the (name, format) list of TRACE_IDS, in ID order."""
+    with open(path) as f:
+        text = f.read()
+
+    # Entries follow the X-macro definition, the comment above it has an example entry.
+    text = text[text.index("#define TRACE_IDS") :]
+
+    return re.findall(r'X\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)', text)
+
+
+def load_freq(path):
+    """Return the app_timer tick frequency of APP_TIMER_CONFIG_RTC_FREQUENCY, the default if it can not be read."""
+    try:
+        with open(path) as f:
+            match = re.search(r"#define\s+APP_TIMER_CONFIG_RTC_FREQUENCY\s+(\d+)", f.read())
+    except OSError:
+        match = None
+
+    # The setting is the RTC prescaler.
+    return RTC_CLOCK / (int(match.group(1)) + 1) if match else DEFAULT_FREQ
+
+
+def format_args(fmt, args):
+    # C conversions used by the trace formats, Python lacks %u and length modifiers.
+    fmt = re.sub(r"%l*u", "%d", re.sub(r"%l+([dxX])", r"%\1", fmt))
+    try:
+        return fmt % tuple(args[: fmt.count("%") - 2 * fmt.count("%%")])
+    except (TypeError, ValueError):
+        return "%s %s" % (fmt, " ".join("0x%x" % a for a in args))
+
+
+def decode(data, ids, freq):
+    offset = 0
+    wraps = 0
+    last = 0
+
+    while offset + HEADER_SIZE <= len(data):
+        rid, size = data[offset], data[offset + 1]
+        ticks = data[offset + 2] | (data[offset + 3] << 8) | (data[offset + 4] << 16)
+        payload = data[offset + HEADER_SIZE : offset + HEADER_SIZE + size]
+        offset += HEADER_SIZE + size
+
+        if len(payload) < size:
+            print("Truncated record at the end of the trace", file=sys.stderr)
+            break
+
+        # RTC counter is 24 bits. A record written by a preempting interrupt may carry a slightly earlier time than
+        # the one before it, possibly from before a wrap, any larger step back is a wrap.
+        step_back = (last - ticks) % TIMESTAMP_WRAP
+        if 0 < step_back <= PREEMPT_TICKS:
+            epoch = wraps if ticks < last else wraps - 1
+        else:
+            if ticks < last:
+                wraps += 1
+            epoch = wraps
+            last = ticks
+        time_ms = ((epoch * TIMESTAMP_WRAP) + ticks) * 1000.0 / freq
+
+        index = rid & ~DATA_FLAG
+        name, fmt = ids[index] if index < len(ids) else ("ID_%d" % index, "")
+
+        if rid & DATA_FLAG:
+            text = "%s [%d] %s" % (fmt, size, " ".join("%02x" % b for b in payload))
+        else:
+            args = struct.unpack("<%dI" % (size // 4), payload[: size - size % 4])
+            text = format_args(fmt, args)
+
+        print("%12.3f ms  %-12s %s" % (time_ms, name, text))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("trace", help="binary capture of the trace RTT channel")
+    parser.add_argument("--ids", default=DEFAULT_IDS, help="trace_ids.h of the firmware")
+    parser.add_argument("--sdk-config", default=DEFAULT_SDK_CONFIG, help="sdk_config.h of the firmware, for the tick frequency")
+    parser.add_argument("--freq", type=float, help="app_timer tick frequency [Hz], overrides --sdk-config")
+    args = parser.parse_args()
+
+    with open(args.trace, "rb") as f:
+        data = f.read()
+
+    decode(data, load_ids(args.ids), args.freq or load_freq(args.sdk_config))
+
+
+if __name__ == "__main__":
+    main()